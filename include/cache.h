@@ -1,46 +1,218 @@
 #ifndef CACHE_H
 #define CACHE_H
 
-#include <unordered_map>
-#include <list>
+#include <deque>
 #include <mutex>
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <string>
+#include "key_traits.h"
+#include "epoch.h"
 
-// 单个缓存段，使用LRU策略
-class LRUCacheSegment
+// 缓存行大小：段对象按缓存行对齐，锁与其余字段分处不同的缓存行
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// 缓存中的 value 以引用计数的不可变缓冲区保存：命中时只复制指针，淘汰或更新不影响已返回的句柄
+using SharedValue = std::shared_ptr<const std::string>;
+
+// 缓存的容量设置：条目数上限由构造参数 capacity 给出（0 表示不限），
+// capacity_bytes 不为 0 时按字节计费，每项计入 key、value 与槽和索引节点的固定开销，两个上限任一超出即淘汰。
+// 单个 value 超过所在段的预算时不缓存
+struct CacheOptions
+{
+    size_t capacity_bytes = 0;
+
+    // 按字节计费时，每 rebalance_interval 次写入按各段自上次调整以来的命中次数重新分配段预算：
+    // 每段保底平均份额的一半，其余按命中比例分给热点段。0 表示各段固定平分
+    size_t rebalance_interval = 0;
+
+    // W-TinyLFU 准入：新项先进入占段容量 window_ratio 的窗口（FIFO），被挤出窗口时与主区的 CLOCK 淘汰候选比较
+    // 估计访问频率，只有更热时才进入主区，否则直接丢弃。一次大范围顺序扫描因此只会冲刷窗口，不会换出主区的热点。
+    // 频率由每段一个 count-min sketch 估计，命中与写入都会计数
+    bool admission = false;
+    double window_ratio = 0.01;
+};
+
+// count-min sketch 频率估计：4 行 4 位饱和计数器（按字节存放），取 4 行中的最小值作为估计。
+// 累计计数达到估计项数的 10 倍后所有计数器减半，使估计偏向近期的访问。
+// 计数器为原子变量，读者可以不加锁计数；并发计数丢失个别增量不影响估计的用途
+class CountMinSketch
+{
+public:
+    explicit CountMinSketch(size_t entries); // entries 为预计同时缓存的项数
+
+    void increment(uint64_t hash);
+    uint8_t estimate(uint64_t hash) const;
+
+private:
+    static constexpr size_t ROWS = 4;
+    static constexpr uint8_t MAX_COUNT = 15;
+
+    size_t index(uint64_t hash, size_t row) const;
+    void age();
+
+    size_t mask_;
+    size_t sample_size_;
+    std::atomic<size_t> additions_{0};
+    std::vector<std::atomic<uint8_t>> counters_;
+};
+
+// 单个缓存段的统计
+struct CacheSegmentStats
+{
+    size_t entries = 0;
+    size_t bytes = 0;  // 已计费的字节数
+    size_t budget = 0; // 当前的字节预算，不按字节计费时为 SIZE_MAX
+    size_t hits = 0;   // 自上次预算调整以来的命中次数，仅在开启调整时统计
+    size_t window_entries = 0; // 开启准入时位于窗口中的项数
+    size_t rejected = 0;       // 开启准入时被挤出窗口但未获准进入主区的项数
+    size_t lock_acquisitions = 0; // 写操作获取段锁的次数（命中与未命中的读取都不加锁）
+    size_t lock_contended = 0;    // 其中未能立即获得、需要等待的次数
+};
+
+// 单个缓存段，使用 CLOCK（second-chance）策略淘汰。
+// 读取不加锁：在纪元临界区内探测一张只存指针的开放寻址表，命中时只置位缓存项的访问标记并复制 value 的引用，
+// 不写段锁或任何段内共享的字段（开启预算调整或准入时另有命中计数）。缓存项发布后除访问标记外不再修改，
+// 更新即替换为新的缓存项；被替换或移除的缓存项和被替换的表经纪元回收，读者离开后才释放。
+// 插入、更新和删除持有段锁。没有空槽时时钟指针扫过槽数组：访问标记为 1 的项清零后获得第二次机会，
+// 遇到标记为 0 的项即淘汰。
+// 段对象按缓存行对齐并连续存放在段数组中：锁与争用计数器独占开头的缓存行，其余字段从下一行开始，
+// 相邻段之间、锁与槽数组等字段之间都不会伪共享
+template <typename Key>
+class alignas(CACHE_LINE_SIZE) BasicClockCacheSegment
 {
 public:
-    LRUCacheSegment(size_t capacity);
-    ~LRUCacheSegment() = default;
+    BasicClockCacheSegment(size_t capacity, size_t budget, bool count_hits, const CacheOptions &options);
+    ~BasicClockCacheSegment(); // 调用者保证已没有读者
+
+    bool get(const Key &key, std::string &value);
+    bool get(const Key &key, SharedValue &value);
+    void put(const Key &key, SharedValue value);
+    void remove(const Key &key);
 
-    bool get(int key, std::string &value);
-    void put(int key, const std::string &value);
-    void remove(int key);
+    // 调整字节预算；预算缩小时立即淘汰到预算以内
+    void setBudget(size_t budget);
+    size_t takeHits(); // 返回并清零命中计数
+    size_t bytes() const;
+    CacheSegmentStats getStats() const;
 
 private:
-    size_t capacity_;
-    std::list<std::pair<int, std::string>> cache_list_;
-    std::unordered_map<int, std::list<std::pair<int, std::string>>::iterator> cache_map_;
-    std::mutex mtx_;
+    // 发布给读者的缓存项：除访问标记外发布后不再修改
+    struct Entry
+    {
+        Key key;
+        SharedValue value;
+        uint64_t hash;
+        size_t pos;                          // 所在的槽
+        std::atomic<bool> referenced{false}; // 自时钟指针上次经过以来是否被访问过
+    };
+
+    // 读者无锁探测的开放寻址表（线性探测），桶中只存缓存项指针。删除留下墓碑使探测链不断开，
+    // 占用（含墓碑）超过一半时按存活项数重建新表并整体替换
+    struct Table
+    {
+        explicit Table(size_t size) : mask(size - 1), buckets(new std::atomic<Entry *>[size]()) {}
+        size_t mask;
+        std::unique_ptr<std::atomic<Entry *>[]> buckets;
+    };
+
+    // 槽只由持有段锁的写者访问
+    struct Slot
+    {
+        Entry *entry = nullptr; // 空槽为 nullptr
+        bool window = false;    // 开启准入时是否位于窗口
+        size_t charge = 0;      // 该项计入的字节数
+    };
+
+    static size_t entryCharge(const Key &key, const std::string &value);
+    static Entry *tombstone(); // 表中被删除的桶
+
+    Entry *find(const Key &key, uint64_t hash) const; // 读者在纪元临界区内调用，写者持有段锁调用
+    void link(Entry *entry);                          // 以下调用者持有段锁：把缓存项加入表，必要时先重建表
+    void unlink(Entry *entry);
+    void rebuild(size_t size);
+
+    size_t allocateSlot();
+    size_t insertEntry(const Key &key, uint64_t hash, SharedValue value, size_t charge, bool referenced); // 返回槽位置
+    void release(size_t pos); // 调用者持有段锁，移除槽中的项并归还空槽
+    void evict();             // 调用者持有段锁且缓存非空，按时钟顺序淘汰一项
+    size_t clockVictim(bool main_only, size_t exclude); // 推进时钟指针直到遇到访问标记为 0 的项，调用者保证存在候选
+    void insertWithAdmission(const Key &key, uint64_t hash, SharedValue value, size_t charge, bool referenced);
+    void admit(size_t candidate); // 被挤出窗口的项与主区淘汰候选比较频率
+
+    // 先尝试获取锁，失败时计入一次争用再阻塞等待
+    std::unique_lock<std::mutex> lockExclusive();
+
+    // 只有写者获取锁，计数器与锁同处一行不会带来额外的缓存行传递
+    mutable std::mutex mtx_;
+    mutable std::atomic<size_t> lock_acquisitions_{0};
+    mutable std::atomic<size_t> lock_contended_{0};
+
+    // 读者只读取表指针，与写者修改的字段分处不同的缓存行
+    alignas(CACHE_LINE_SIZE) std::atomic<Table *> table_;
+
+    alignas(CACHE_LINE_SIZE) size_t capacity_; // 条目数上限，0 表示不限
+    std::deque<Slot> slots_; // 按需增长，已有槽的地址不变
+    size_t entries_ = 0;     // 存活的缓存项数
+    size_t tombstones_ = 0;  // 表中的墓碑数
+    RetireList retired_;     // 被替换或移除、等待读者离开的缓存项与表
+    std::vector<size_t> free_slots_;
+    size_t hand_ = 0; // 时钟指针
+    std::atomic<size_t> bytes_{0};
+    std::atomic<size_t> budget_;
+    std::atomic<size_t> hits_{0};
+    bool count_hits_;
+
+    // 准入相关状态，仅在 admission_ 为 true 时使用
+    bool admission_;
+    double window_ratio_;
+    std::deque<size_t> window_; // 窗口中的槽，按进入顺序排列
+    size_t window_bytes_ = 0;
+    size_t rejected_ = 0;
+    std::unique_ptr<CountMinSketch> sketch_;
 };
 
-// 分段缓存
-class LRUCache
+// 分段缓存：段数取 2 的幂，用混合后的 key 哈希的高位按掩码选段。
+// num_segments 为 0 时按硬件线程数自动确定（线程数的两倍向上取 2 的幂），但保证每段至少 16 项或 64 KiB；
+// 非 2 的幂的段数向上取整
+template <typename Key>
+class BasicClockCache
 {
 public:
-    LRUCache(size_t capacity, size_t num_segments);
-    ~LRUCache() = default;
+    BasicClockCache(size_t capacity, size_t num_segments, const CacheOptions &options = CacheOptions());
+    ~BasicClockCache();
+    BasicClockCache(const BasicClockCache &) = delete;
+    BasicClockCache &operator=(const BasicClockCache &) = delete;
 
-    bool get(int key, std::string &value);
-    void put(int key, const std::string &value);
-    void remove(int key);
+    // 复制 value 的版本在锁外复制；SharedValue 版本只增加引用计数，不复制也不分配
+    bool get(const Key &key, std::string &value);
+    bool get(const Key &key, SharedValue &value);
+    void put(const Key &key, const std::string &value);
+    void put(const Key &key, SharedValue value);
+    void remove(const Key &key);
+
+    size_t memoryUsage() const; // 所有段已计费的字节数之和
+    std::vector<CacheSegmentStats> getSegmentStats() const;
 
 private:
+    void rebalance();
+
     size_t num_segments_;
-    std::vector<std::unique_ptr<LRUCacheSegment>> segments_;
+    size_t segment_mask_;
+    BasicClockCacheSegment<Key> *segments_; // 按缓存行对齐的连续段数组
+    CacheOptions options_;
+    std::atomic<size_t> puts_{0};
+    std::mutex rebalance_mtx_;
 
-    size_t getSegmentIndex(int key);
+    size_t getSegmentIndex(const Key &key);
 };
 
+using ClockCache = BasicClockCache<int>;
+
+// 原先的 LRU 缓存名称，保留给已有的调用者，接口与 BasicClockCache 兼容
+template <typename Key>
+using BasicLRUCache = BasicClockCache<Key>;
+using LRUCache = ClockCache;
+
 #endif // CACHE_H
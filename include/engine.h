@@ -1,11 +1,12 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
-#include "file_store.h"
+#include "sharded_store.h"
 #include "thread_pool.h"
 #include "cache.h"
 #include <string>
 #include <functional>
+#include <vector>
 
 #ifdef _WIN32
 #ifdef BUILD_DLL
@@ -17,34 +18,74 @@
 #define EXPORT
 #endif
 
-class EXPORT StorageEngine
+// Key 为 int 或 std::string（任意字节串，长度不超过 64 KiB）
+template <typename Key>
+class EXPORT BasicStorageEngine
 {
 public:
-  StorageEngine(const std::string &storage_file, size_t thread_pool_size = 4, size_t cache_capacity = 100, size_t cache_num_segments = 8);
-  ~StorageEngine();
+  using ScanEntry = BasicScanEntry<Key>;
+
+  // shard_count 为存储分片数，每个分片是独立的 FileStore；已有数据时以创建时的分片数为准。
+  // cache_capacity 为缓存条目数上限（0 表示不限），cache_options.capacity_bytes 另设字节预算；
+  // cache_num_segments 为 0 时按硬件线程数自动确定缓存段数
+  BasicStorageEngine(const std::string &storage_file, size_t thread_pool_size = 4, size_t cache_capacity = 100, size_t cache_num_segments = 0,
+                     size_t shard_count = 1, const FileStoreOptions &store_options = FileStoreOptions(),
+                     const CacheOptions &cache_options = CacheOptions());
+  ~BasicStorageEngine();
   void stop(); // 用于停止接受新任务
 
   // 提供公共的垃圾回收接口
   void garbageCollect();
 
-  // 异步接口
-  void asyncPut(int key, const std::string &value, std::function<void(bool)> callback);
-  void asyncGet(int key, std::function<void(std::string)> callback);
-  void asyncDel(int key, std::function<void(bool)> callback);
+  // 将已写入的数据同步到磁盘；持久化策略由构造时的 FileStoreOptions::sync_mode 决定
+  bool sync();
+
+  // 异步接口：回调在线程池上执行，其中可以再调用本实例的同步接口
+  void asyncPut(const Key &key, const std::string &value, std::function<void(bool)> callback);
+  void asyncGet(const Key &key, std::function<void(std::string)> callback);
+  void asyncDel(const Key &key, std::function<void(bool)> callback);
 
   // 辅助方法，用于处理缓存逻辑
-  bool put(int key, const std::string &value);
-  std::string get(int key);
-  bool del(int key);
+  bool put(const Key &key, const std::string &value);
+  std::string get(const Key &key);
+  bool del(const Key &key);
+
+  // 共享读取：缓存命中时返回与缓存共用的只读缓冲区，不复制也不分配；未命中时从存储读取，
+  // 同一个缓冲区放入缓存后返回。对象不存在时返回空指针。句柄在对象被更新、删除或淘汰后仍然有效
+  SharedValue getShared(const Key &key);
+  void asyncGetShared(const Key &key, std::function<void(SharedValue)> callback);
+
+  // 批量接口：multiGet 先查缓存，未命中的 key 交给存储一次批量读取；multiPut 每个分片只追加写入一次。
+  // 异步版本在存储支持 io_uring 时直接提交，否则整批只占用线程池的一个任务；回调各执行一次
+  std::vector<std::string> multiGet(std::span<const Key> keys);
+  bool multiPut(std::span<const std::pair<Key, std::string>> items);
+  void asyncMultiGet(std::span<const Key> keys, std::function<void(std::vector<std::string>)> callback);
+  void asyncMultiPut(std::span<const std::pair<Key, std::string>> items, std::function<void(bool)> callback);
+
+  // 原子批次：整批一次追加写入、在一次索引临界区内发布，随后一次遍历使批次涉及的缓存项失效。
+  // 单分片时整批原子；多分片时按分片拆分，每个分片内原子
+  bool write(const BasicWriteBatch<Key> &batch);
+  void asyncWrite(const BasicWriteBatch<Key> &batch, std::function<void(bool)> callback);
+
+  // 范围扫描：按 key 升序返回 [start, end) 中最多 limit 个对象，直接读取存储，不经过也不填充缓存。
+  // 分页遍历时以上一页最后一个 key 的后继（int 为 key + 1，字节串为 key 末尾追加 '\0'）作为下一次的 start
+  std::vector<ScanEntry> scan(const Key &start, const Key &end, size_t limit = SIZE_MAX);
 
   // 获取 FileStore 的读取计数
   size_t getFileStoreReadCount() const;
 
+  // 缓存当前计费的字节数与各段的统计
+  size_t getCacheMemoryUsage() const;
+  std::vector<CacheSegmentStats> getCacheSegmentStats() const;
+
 private:
   std::atomic<bool> stopped_{false};
   ThreadPool thread_pool_;                // 线程池
-  std::unique_ptr<FileStore> file_store_; // 文件存储
-  LRUCache cache_;                        // 缓存
+  std::unique_ptr<BasicShardedFileStore<Key>> file_store_; // 按 key 分片的文件存储
+  BasicClockCache<Key> cache_;                             // 缓存（CLOCK 淘汰，命中不持有独占锁）
 };
 
+using StorageEngine = BasicStorageEngine<int>;
+using StringStorageEngine = BasicStorageEngine<std::string>;
+
 #endif // ENGINE_H
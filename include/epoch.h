@@ -0,0 +1,61 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 基于纪元（epoch）的内存回收：读者不加锁地访问写者随时可能摘除的对象，摘除的对象等到
+// 所有可能看到它的读者都离开后才释放。
+// 读者用 EpochGuard 登记进入时的纪元，只写自己线程的记录（独占一个缓存行），读者之间不共享被写的缓存行；
+// 全局纪元只在写者回收时推进，读者只读取它。
+
+// 读者的临界区：构造时登记，析构时离开，可以嵌套
+class EpochGuard
+{
+public:
+    EpochGuard();
+    ~EpochGuard();
+    EpochGuard(const EpochGuard &) = delete;
+    EpochGuard &operator=(const EpochGuard &) = delete;
+};
+
+// 写者的待回收列表：对象从共享结构中摘除后交给 retire，不再被任何读者引用时释放。
+// 本身不加锁，由调用者保证串行访问（例如持有缓存段的独占锁）
+class RetireList
+{
+public:
+    RetireList() = default;
+    ~RetireList(); // 调用者保证此时已没有读者，释放全部对象
+    RetireList(const RetireList &) = delete;
+    RetireList &operator=(const RetireList &) = delete;
+
+    template <typename T>
+    void retire(T *ptr)
+    {
+        push(ptr, [](void *p)
+             { delete static_cast<T *>(p); });
+    }
+
+    size_t size() const { return items_.size(); } // 尚未释放的对象数
+
+private:
+    struct Retired
+    {
+        void *ptr;
+        void (*deleter)(void *);
+        uint64_t epoch; // 摘除后读到的全局纪元
+    };
+
+    // 每积累这么多对象尝试回收一次；有读者长时间停留时下一次回收相应推迟，避免反复扫描
+    static constexpr size_t RECLAIM_BATCH = 64;
+
+    void push(void *ptr, void (*deleter)(void *));
+    void reclaim();
+
+    std::vector<Retired> items_;
+    size_t reclaim_at_ = RECLAIM_BATCH;
+};
+
+#endif // EPOCH_H
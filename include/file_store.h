@@ -3,64 +3,411 @@
 
 #include <string>
 #include <unordered_map>
+#include <map>
 #include <mutex>
 #include <shared_mutex>
 #include <fstream>
 #include <vector>
 #include <atomic>
 #include <thread>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <type_traits>
+#include <span>
+#include <utility>
+#include "record.h"
+#include "io_ring.h"
+#include "index_table.h"
+#include "ordered_index.h"
+#include "write_batch.h"
 
-// 对象元数据
-struct ObjectMeta
+// 日志段：大小有上限的数据文件，写满后封存，此后只读。
+// blob 文件是只存放大 value 记录的段，与主日志共用 id 空间、记录格式和索引，文件名多一个 .blob 后缀
+struct Segment
 {
-    int key;              // 对象的Key
-    size_t offset;        // 数据在文件中的偏移量
-    size_t size;          // 数据大小
-    bool deleted = false; // 标记该对象是否已删除
+    uint32_t id;
+    bool blob = false;
+    int fd = -1;
+    std::atomic<size_t> size{0};       // 已写入字节数（含段头）
+    std::atomic<size_t> live_bytes{0}; // 仍被索引引用的记录（含墓碑）字节数
+    std::atomic<size_t> dead_bytes{0}; // 被覆盖、删除的记录以及失效墓碑占用的字节数
+    std::atomic<uint64_t> min_seq{UINT64_MAX}; // 段中记录的最小序列号，未知时为 0
+    std::atomic<bool> sealed{false};   // 封存后不再追加
+    char *map = nullptr;               // 只读映射（mmap 模式），随段一起释放
+    size_t map_size = 0;               // 映射长度，当前段按段大小上限预先映射
+    bool hint_tracked = false;         // 自创建起记录了全部提示项，封存时可写出提示文件
+    std::string hint;                  // 尚未写出的提示项，只由提交令牌持有者或压缩线程追加
+    size_t hint_entries = 0;           // hint 中的提示项数（字节串 key 的提示项不定长）
+
+    ~Segment();
+};
+
+// 段的垃圾统计快照
+struct SegmentStats
+{
+    uint32_t id;
+    size_t size;
+    size_t live_bytes;
+    size_t dead_bytes;
+    bool sealed;
+    bool blob;
+};
+
+// GC 运行统计
+struct GCStats
+{
+    size_t runs = 0;                  // 实际执行压缩的次数
+    size_t skipped = 0;               // 检查后因未达阈值而跳过的次数
+    size_t last_reclaimed_bytes = 0;  // 最近一次压缩回收的磁盘字节数
+    size_t total_reclaimed_bytes = 0; // 累计回收的磁盘字节数
+    double dead_ratio = 0;            // 当前垃圾字节占数据字节的比例
+    double space_amplification = 1;  // 当前磁盘占用与有效数据之比
+};
+
+// 持久化策略
+enum class SyncMode
+{
+    None,     // 只写入页缓存，由内核决定何时落盘，崩溃（掉电）时可能丢失最近的写入
+    Interval, // 后台线程按时间间隔或累计字节数 fdatasync，最多丢失一个间隔内的写入
+    PerWrite, // 每个提交批次写入后 fdatasync，写入返回即已落盘；组提交使并发写入共享一次同步
+};
+
+// FileStore 配置
+struct FileStoreOptions
+{
+    size_t segment_size = 64 * 1024 * 1024; // 单个段的大小上限，写满后滚动到新段
+    double compact_garbage_ratio = 0.5;      // 段内垃圾比例达到该值才会被压缩
+    size_t max_compact_segments = 8;         // 每次 GC 最多压缩的段数
+    size_t compaction_threads = 2;           // 并行拷贝的线程数上限，每个线程负责一部分段并写入各自的输出段
+
+    // GC 调度：后台线程按间隔检查，任一阈值达到且垃圾量足够时才压缩
+    std::chrono::milliseconds gc_check_interval{10000}; // 检查间隔
+    double gc_trigger_dead_ratio = 0.3;                 // 全局垃圾比例阈值
+    double gc_trigger_space_amplification = 2.0;        // 空间放大阈值
+    size_t gc_min_dead_bytes = 4 * 1024 * 1024;         // 垃圾少于该值时不值得压缩
+
+    // mmap 读模式：段映射到内存，get 直接从映射拷贝，不再经过 pread 系统调用。
+    // 映射归段所有，读者持有段的引用即可安全访问，压缩删除段后映射在最后一个读者结束时释放。
+    bool use_mmap = false;
+
+    // 异步接口使用 io_uring 提交读写，内核不支持时自动回退到同步 I/O
+    bool use_io_uring = true;
+    unsigned io_uring_entries = 256; // 提交队列深度，也是在途请求数的上限
+
+    // 段封存和压缩输出时写出提示文件，恢复时据此重建索引而不读取 value；
+    // 代价是当前段的每条记录在内存中多占一个提示项
+    bool hint_files = true;
+
+    // 自上次检查点以来追加超过该字节数时由后台线程保存新的检查点，限制重启时需要重放的日志长度。
+    // 上一个检查点比该值大时以检查点大小为准，保存检查点写出的字节数因此不超过日志的追加量。
+    // 0 表示只在压缩和关闭时保存检查点
+    size_t checkpoint_interval_bytes = 64 * 1024 * 1024;
+
+    // 持久化：检查点、提示文件和压缩输出段在 None 以外的模式下也会在发布前同步
+    SyncMode sync_mode = SyncMode::None;
+    std::chrono::milliseconds sync_interval{1000}; // Interval 模式的同步间隔
+    size_t sync_interval_bytes = 0;                // Interval 模式下累计未同步字节达到该值时提前同步，0 表示不限
+
+    // 额外维护按 key 有序的索引，范围扫描只访问区间内的 key；
+    // 关闭时 scan 仍可用，但需要遍历整个哈希索引
+    bool ordered_index = false;
+
+    // 内联小 value：不超过阈值的 value 在写入日志的同时把副本保存在索引项中，get 直接从内存返回。
+    // 内联占用受 inline_value_budget 约束：预算用尽时阈值减半，占用回落到预算一半以下时逐步恢复到 inline_value_max_size。
+    // 重启后在加载索引时按预算从日志读回内联的 value。inline_value_max_size 为 0 时关闭
+    size_t inline_value_max_size = 0;
+    size_t inline_value_budget = 64 * 1024 * 1024;
+
+    // 键值分离：不小于 blob_value_threshold 的 value 写入单独的 blob 文件，索引直接指向其中的记录，
+    // 主日志只保存小记录与墓碑，主日志压缩因此不再搬移大 value。blob 文件不会被提前封存，
+    // 只有垃圾比例达到 blob_gc_garbage_ratio 时才被重写。原子批次中的 value 仍写入主日志，
+    // 以保持批次帧的原子性。blob_value_threshold 为 0 时关闭
+    size_t blob_value_threshold = 0;
+    size_t blob_file_size = 256 * 1024 * 1024; // 单个 blob 文件的大小上限
+    double blob_gc_garbage_ratio = 0.5;
+};
+
+// 内联 value 的统计
+struct InlineValueStats
+{
+    size_t bytes = 0;     // 内联 value 占用的内存（含分配开销）
+    size_t threshold = 0; // 当前的内联阈值
+    size_t hits = 0;      // 由内联 value 直接返回的读取次数
+};
+
+// 范围扫描的结果项
+template <typename Key>
+struct BasicScanEntry
+{
+    Key key;
+    std::string value;
+};
+using ScanEntry = BasicScanEntry<int>;
+
+// 组提交队列中等待写入的请求
+template <typename Key>
+struct BasicWriteRequest
+{
+    Key key;
+    const std::string *value;
+    bool tombstone = false; // 删除请求，写入墓碑记录
+    bool done = false;      // 由 leader 在写入并发布索引后置位
+    bool success = false;   // 写入结果
+
+    // 异步请求：在堆上分配并持有 value，完成后调用回调并释放，不使用 done
+    std::string owned_value{};
+    std::function<void(bool)> callback{};
+
+    // 原子批次：非空时忽略 key 与 value，整批编码为一个批次帧；异步请求持有批次的副本
+    const BasicWriteBatch<Key> *batch = nullptr;
+    BasicWriteBatch<Key> owned_batch{};
+};
+
+// leader 已编码、待写入的一批请求
+template <typename Key>
+struct BasicPendingCommit
+{
+    std::vector<BasicWriteRequest<Key> *> requests;
+    std::string buffer;               // 连续编码的记录
+    std::shared_ptr<Segment> segment; // 写入的段
+    size_t offset = 0;                // 写入位置
+    std::string blob_buffer;               // 写入 blob 文件的大 value 记录
+    std::shared_ptr<Segment> blob_segment; // 没有大 value 时为空
+    size_t blob_offset = 0;
+    uint64_t first_seq = 0;           // 本批第一条记录的序列号，失败时回退
 };
 
-// 文件存储引擎类
-class FileStore
+// 文件存储引擎类。Key 为 int 或 std::string（任意字节串，长度不超过 RECORD_MAX_KEY_SIZE），
+// 两种实例在 file_store.cpp 中显式实例化；key 类型相关的编码与哈希见 KeyTraits
+template <typename Key>
+class BasicFileStore
 {
 public:
-    FileStore(const std::string &file_path, bool clean_start = false);
-    ~FileStore();
+    using ObjectMeta = BasicObjectMeta<Key>;
+    using WriteRequest = BasicWriteRequest<Key>;
+    using PendingCommit = BasicPendingCommit<Key>;
+    using HintEntry = BasicHintEntry<Key>;
+    using ScanEntry = BasicScanEntry<Key>;
+
+    BasicFileStore(const std::string &file_path, bool clean_start = false, const FileStoreOptions &options = FileStoreOptions());
+    ~BasicFileStore();
 
     // 删除复制构造函数和复制赋值运算符
-    FileStore(const FileStore &) = delete;
-    FileStore &operator=(const FileStore &) = delete;
+    BasicFileStore(const BasicFileStore &) = delete;
+    BasicFileStore &operator=(const BasicFileStore &) = delete;
+
+    // 同步操作；key 超过长度上限时 put 返回 false
+    bool put(const Key &key, const std::string &value);
+    std::string get(const Key &key);
+    bool del(const Key &key);
+
+    // 异步操作：启用 io_uring 时提交后立即返回，回调在完成线程上执行；
+    // 否则在调用线程上同步执行后回调。回调中不应调用同一实例的同步写接口。
+    // 写入 blob 文件的大 value 由 leader 同步写出，只有主日志部分经过 io_uring
+    void asyncGet(const Key &key, std::function<void(std::string)> callback);
+    void asyncPut(const Key &key, const std::string &value, std::function<void(bool)> callback);
+    void asyncDel(const Key &key, std::function<void(bool)> callback);
+    bool hasAsyncIo() const; // io_uring 是否可用
+
+    // 批量读取：一次索引加锁查出所有 key 的位置，按段和偏移排序后把相邻的记录合并成大块读取；
+    // 结果与 keys 一一对应，不存在的 key 对应空串。异步版本每个读取块提交一个 io_uring 读请求，
+    // 全部完成后回调一次。keys 只需在调用期间有效
+    std::vector<std::string> multiGet(std::span<const Key> keys);
+    void asyncMultiGet(std::span<const Key> keys, std::function<void(std::vector<std::string>)> callback);
 
-    // 同步操作
-    bool put(int key, const std::string &value);
-    std::string get(int key);
-    bool del(int key);
+    // 批量写入：整批作为一个提交批次编码，一次追加写入、一次索引临界区内发布。
+    // 任一 key 超过长度上限时整批不写入，返回 false
+    bool multiPut(std::span<const std::pair<Key, std::string>> items);
+    void asyncMultiPut(std::span<const std::pair<Key, std::string>> items, std::function<void(bool)> callback);
+
+    // 原子批次：整批编码为一个批次帧一次追加，并在一次索引临界区内发布，
+    // 读者看不到只应用了一部分的批次，崩溃后也不会恢复出半个批次。空批次直接返回 true
+    bool write(const BasicWriteBatch<Key> &batch);
+    void asyncWrite(const BasicWriteBatch<Key> &batch, std::function<void(bool)> callback);
+
+    // 范围扫描：按 key 升序返回 [start, end) 中最多 limit 个有效对象，字节串 key 按字典序。
+    // 读取前按段和偏移排序，相邻记录合并成大块的顺序读
+    std::vector<ScanEntry> scan(const Key &start, const Key &end, size_t limit = SIZE_MAX);
+
+    // 将当前段已写入的数据同步到磁盘
+    bool sync();
+    size_t getSyncCount() const; // 数据段执行 fdatasync 的次数
 
     size_t getReadCount() const;
+    size_t getCommitBatchCount() const;         // 组提交实际执行的写入批次数
+    std::vector<SegmentStats> getSegmentStats(); // 各段（含 blob 文件）的大小与垃圾统计
 
-    // 垃圾回收
-    void garbageCollect();
+    // 垃圾回收：只压缩垃圾比例最高的封存段，拷贝期间读写照常进行，返回回收的字节数
+    size_t garbageCollect();
+    GCStats getGCStats();
+    InlineValueStats getInlineValueStats();
 
 private:
-    std::string file_path_;                     // 文件路径
-    std::fstream file_;                         // 文件流
-    std::unordered_map<int, ObjectMeta> index_; // 索引表 (Key -> ObjectMeta)
-    std::shared_mutex index_mtx_;               // 用于保护索引的读写锁
-    std::mutex file_mtx_;                       // 用于保护文件操作的互斥锁
-    size_t file_size_;                          // 文件当前大小 (用于定位新写入数据的偏移量)
-    std::atomic<bool> stop_gc_thread_;          // 标记垃圾回收线程是否停止
+    using Traits = KeyTraits<Key>;
+
+    // int key 沿用定长的检查点与提示文件格式，字节串 key 使用变长格式
+    static constexpr bool FIXED_SIZE_KEYS = std::is_same_v<Key, int>;
+    static constexpr uint32_t INDEX_VERSION = FIXED_SIZE_KEYS ? INDEX_FILE_VERSION : INDEX_FILE_VERSION_BYTE_KEYS;
+    static constexpr uint32_t HINT_VERSION = FIXED_SIZE_KEYS ? HINT_FILE_VERSION : HINT_FILE_VERSION_BYTE_KEYS;
+
+    std::string file_path_; // 段文件路径前缀，段文件名为 <file_path_>.<id>
+    FileStoreOptions options_;
+
+    BasicIndexTable<Key> index_;                // 索引表 (Key -> ObjectMeta)，开放寻址的扁平哈希表
+    BasicOrderedKeyIndex<Key> ordered_keys_;    // 有效 key 的有序索引，仅在 ordered_index 选项开启时维护
+    std::shared_mutex index_mtx_;               // 用于保护索引的读写锁，段的加入与移除也在其独占锁内完成
+    std::mutex gc_mtx_;                         // 同一时刻只运行一个压缩
+    std::mutex checkpoint_mtx_;                 // 串行化检查点的写入
+
+    std::map<uint32_t, std::shared_ptr<Segment>> segments_; // 所有段，按 id 有序
+    std::shared_ptr<Segment> active_;                       // 当前追加的段
+    std::shared_ptr<Segment> blob_active_;                  // 当前追加的 blob 文件，第一次写入大 value 时创建
+    std::shared_mutex segments_mtx_;                        // 保护 segments_、active_ 与 blob_active_，加锁顺序在最内层
+    std::atomic<uint32_t> next_segment_id_;                 // 下一个新段的 id
+
+    uint64_t next_seq_;                          // 下一条记录的序列号，仅由 leader 修改
+    uint64_t published_seq_;                     // 已发布到索引的下一个序列号，受 index_mtx_ 保护
+    std::atomic<size_t> bytes_since_checkpoint_; // 自上次检查点以来追加的字节数
+    std::atomic<size_t> last_checkpoint_size_{0}; // 上一个检查点文件的字节数
+    std::atomic<bool> checkpoint_requested_{false}; // 写入路径请求 GC 线程保存检查点
+
+    std::atomic<bool> stop_gc_thread_; // 标记垃圾回收线程是否停止
     std::thread gc_thread_;
+    std::mutex gc_wait_mtx_;          // 配合 gc_cv_ 实现可中断的等待
+    std::condition_variable gc_cv_;   // 析构或请求检查点时唤醒 GC 线程
+    GCStats gc_stats_;                // 受 gc_mtx_ 保护
     std::atomic<size_t> read_count_; // get访问底层存储的计数
 
+    size_t inline_threshold_ = 0;          // 当前的内联阈值，受 index_mtx_ 保护
+    std::atomic<size_t> inline_hits_{0};   // 由内联 value 直接返回的读取次数
+    bool admitInline(size_t value_size);   // 持有索引独占锁时决定一个 value 是否内联，并按预算调整阈值
+    void loadInlineValues();               // 加载索引后按预算读回内联的 value
+
+    // Interval 模式的后台同步线程
+    std::thread sync_thread_;
+    std::mutex sync_wait_mtx_;
+    std::condition_variable sync_cv_;
+    bool stop_sync_thread_ = false;         // 受 sync_wait_mtx_ 保护
+    std::atomic<size_t> unsynced_bytes_{0}; // 自上次同步以来追加的字节数
+    std::atomic<size_t> sync_count_{0};
+
+    // 组提交：并发的 put 排队，由一个 leader 合并成一次写入
+    std::mutex commit_mtx_;                   // 保护提交队列
+    std::condition_variable commit_cv_;       // 唤醒等待提交完成的写入者
+    std::deque<WriteRequest *> commit_queue_; // 等待写入的请求
+    bool commit_leader_active_ = false;       // 提交令牌：持有者是唯一的追加者，GC 切换当前段时也需持有
+    std::atomic<size_t> commit_batch_count_;  // 已执行的写入批次数
+
+    // 异步操作计数，析构前等待所有回调执行完毕
+    std::mutex async_mtx_;
+    std::condition_variable async_cv_;
+    size_t async_pending_ = 0;
+
+    // 将连续的 count 个请求一起加入提交队列（因此落在同一批次中），必要时成为 leader 执行写入
+    bool submitWrites(WriteRequest *requests, size_t count);
+    void submitWritesAsync(const std::vector<WriteRequest *> &requests); // 请求在堆上分配，完成后由回调路径释放
+
+    // 持有提交令牌时处理队列中的所有批次，队列为空后交还令牌。
+    // async 为 true 时批次通过 io_uring 写入，本函数提交后即返回，由完成回调继续处理
+    void driveCommits(bool async);
+    bool prepareCommit(PendingCommit &commit);          // 编码一批记录，必要时滚动段
+    std::shared_ptr<Segment> appendTarget(bool blob, size_t bytes); // 能容纳 bytes 字节的当前段，放不下时滚动
+    bool isBlobRecord(const WriteRequest &request, const std::string *value) const; // 该记录是否写入 blob 文件
+    void finishCommit(PendingCommit &commit, bool ok); // 在一次索引临界区内发布并通知请求者
+    void completeAsyncCommit(const std::shared_ptr<PendingCommit> &commit, bool ok); // 完成线程上结束一批并继续下一批
+    void acquireCommitToken();                          // 等待当前 leader 交还令牌后占有它
+
+    // 按日志顺序访问请求写入的每条记录：批次的每个操作，或单条 put / del；删除时 value 为 nullptr
+    template <typename Visitor>
+    static void forEachRecord(const WriteRequest &request, Visitor &&visitor);
+
+    void beginAsyncOp();
+    void endAsyncOp();
+    std::string readValue(const std::shared_ptr<Segment> &seg, const ObjectMeta &meta); // 读取索引项指向的 value
+
+    // 批量读取（scan 与 multiGet）：按段和偏移排序后，同一段中相邻的记录合并为一个读取块
+    struct ReadItem
+    {
+        ObjectMeta meta;
+        std::shared_ptr<Segment> seg;
+        size_t slot; // 在结果中的位置
+        bool ok = false;
+    };
+    struct ReadChunk
+    {
+        size_t first; // 块内的记录为 items 中的 [first, last)
+        size_t last;
+        size_t start; // 块在段内的范围 [start, end)
+        size_t end;
+    };
+    std::vector<ReadChunk> planReads(std::vector<ReadItem> &items);
+    bool lookupLocked(const Key &key, size_t slot, std::vector<ReadItem> &items, std::vector<std::string> &values);
+    // 一次索引加锁查出所有 key 的位置，内联的 value 直接写入 values
+    void lookupForRead(std::span<const Key> keys, std::vector<ReadItem> &items, std::vector<std::string> &values);
+    void copyValues(const ReadChunk &chunk, const char *base, std::vector<ReadItem> &items, std::vector<std::string> &values);
+    void readChunks(std::vector<ReadItem> &items, std::vector<std::string> &values); // 同步读取所有块
+
     // 启动垃圾回收线程
     void startGCThread();
+    void startSyncThread(); // Interval 模式下启动后台同步线程
+    bool syncSegment(const Segment &segment);
+    void syncDirectory();   // 新建或重命名文件后同步所在目录
+    bool shouldCollect(); // 根据垃圾比例与空间放大判断是否值得压缩，并刷新统计
+
+    // 段管理
+    std::string segmentPath(uint32_t id, bool blob = false) const;
+    std::shared_ptr<Segment> createSegment(uint32_t id, bool blob = false, bool temp = false); // 创建新段文件并写入段头，temp 时使用临时文件名
+    std::shared_ptr<Segment> findSegment(uint32_t id);           // 按 id 查找段
+    size_t segmentCapacity(const Segment &segment) const;        // 段的大小上限
+    void mapSegment(Segment &segment);                           // mmap 模式下映射段文件
+    void rollSegment(bool blob = false);                         // 封存当前段（或 blob 文件）并切换到新的
+    void markDead(const ObjectMeta &meta);                       // 记录被覆盖或删除时更新段的垃圾统计
+    void writeHintFile(Segment &segment);                        // 写出段的提示文件并释放内存中的提示项
+    std::vector<std::shared_ptr<Segment>> pickCompactionVictims(bool blob); // 按垃圾比例挑选待压缩的段或 blob 文件
+
+    // 顺序扫描段中从 start 开始的记录，遇到截断或损坏即停止，返回有效数据的末尾位置
+    using RecordVisitor = std::function<void(const RecordHeader &, const Key &, size_t, const char *)>;
+    size_t scanSegment(const Segment &segment, size_t start, const RecordVisitor &visitor);
+
+    // 从提示文件读取封存段的全部记录位置，提示文件缺失、损坏或与段不一致时返回 false
+    bool loadHintFile(const Segment &segment, const std::function<void(const HintEntry &)> &visitor);
+    bool readHintHeader(const Segment &segment, HintFileHeader &header); // 只读取并校验提示文件头
 
     // 索引管理
-    void loadIndex();        // 从文件加载索引
-    void saveIndex();        // 保存索引到文件
+    void loadIndex();        // 打开所有段，加载检查点并重放其后的日志尾部
+    void saveIndex();        // 在索引共享锁下将一致的检查点保存到文件
     void printFileContext(); // 打印data文件的内容
 
-    // 压缩文件
-    void compactFile(const std::vector<ObjectMeta> &live_objects);
+    // 在线压缩选中的段：不持锁拷贝有效记录到新段，再在短临界区内合并索引并删除旧段。
+    // victims 全部是主日志段或全部是 blob 文件，输出段与之同类
+    size_t compactSegments(const std::vector<std::shared_ptr<Segment>> &victims);
+    struct CompactionMove // 拷贝计划：旧位置 -> 新位置
+    {
+        uint32_t from_segment;
+        size_t from_offset;
+        ObjectMeta to;
+    };
+    struct CompactionResult // 一个拷贝线程的输出
+    {
+        std::vector<std::shared_ptr<Segment>> outputs;
+        std::vector<CompactionMove> moves;
+        std::vector<ObjectMeta> tombstones; // 可以丢弃的墓碑
+        bool ok = true;
+    };
+    bool copyLiveRecords(const Segment &victim, uint64_t seq_floor, CompactionResult &result);
+
+    // 定位读写，处理短读/短写
+    static bool preadFull(int fd, char *buf, size_t size, size_t offset);
+    static bool pwriteFull(int fd, const char *buf, size_t size, size_t offset);
+    static bool copyRange(int from_fd, size_t from_offset, int to_fd, size_t to_offset, size_t size); // 文件间拷贝
+
+    std::unique_ptr<IoRing> io_ring_; // 最后声明、最先析构，此时已没有在途请求
 };
 
+using FileStore = BasicFileStore<int>;
+using StringFileStore = BasicFileStore<std::string>;
+
 #endif // FILE_STORE_H
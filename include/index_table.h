@@ -0,0 +1,125 @@
+#ifndef INDEX_TABLE_H
+#define INDEX_TABLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include "key_traits.h"
+
+// 对象元数据（索引项解码后的形式）
+template <typename Key>
+struct BasicObjectMeta
+{
+    Key key;              // 对象的Key
+    uint32_t segment_id;  // 记录所在的段
+    size_t offset;        // 记录在段文件中的偏移量（指向记录头）
+    size_t size;          // value 大小
+    bool deleted = false; // 标记该对象是否已删除（offset 指向墓碑记录）
+    const char *value = nullptr; // 内联在索引中的 value（size 字节），只在持有索引锁期间有效
+};
+using ObjectMeta = BasicObjectMeta<int>;
+
+// FileStore 的主索引：开放寻址的扁平哈希表。
+// 每个槽保存 key | size(4，全 1 表示墓碑) | segment_id(24 位) + offset(40 位)，int key 的槽共 16 字节，
+// 字节串 key 以 SmallKey 内联存放；另有 1 字节控制字存放哈希的低 7 位。查找按 16 个控制字一组用 SSE2 并行比较，
+// 一次比较即可排除组内绝大多数槽。扩容时新旧两张表并存，每次修改顺带迁移一小批槽，
+// 插入不会因整表重哈希而停顿。
+// 启用内联 value 后，每个槽在与槽数组平行的数组中多一个指针，小 value 的副本单独分配并随槽移动；
+// 未启用时不分配该数组，槽的大小不变。
+// 本身不加锁，由调用者（FileStore 的 index_mtx_）保证并发安全；只有修改操作会迁移数据。
+template <typename Key>
+class BasicIndexTable
+{
+public:
+    using Meta = BasicObjectMeta<Key>;
+
+    static constexpr uint32_t MAX_SEGMENT_ID = (1u << 24) - 1;
+    static constexpr uint64_t MAX_OFFSET = (uint64_t(1) << 40) - 1;
+
+    BasicIndexTable() = default;
+
+    bool find(const Key &key, Meta &meta) const; // 查找 key，找到时解码到 meta
+    void insert(const Meta &meta);               // 插入或覆盖；meta.value 非空时内联一份副本，否则丢弃已内联的 value
+    bool relocate(const Meta &meta);             // 只更新已有 key 的位置（压缩搬移记录），保留内联的 value
+    bool erase(const Key &key);
+    size_t size() const;
+    void reserve(size_t count); // 预先分配容纳 count 个 key 的空间
+    void clear();
+    size_t memoryUsage() const; // 槽、控制字与内联指针数组占用的字节数（不含堆上的长 key 与内联 value）
+
+    void enableInlineValues();  // 启用内联 value，此后 insert 才会保存 meta.value
+    size_t inlineBytes() const; // 内联 value 占用的字节数（含分配开销）
+    static size_t inlineCost(size_t size)
+    {
+        return size + INLINE_VALUE_OVERHEAD;
+    }
+
+    // 遍历所有索引项（顺序不确定）
+    template <typename Visitor>
+    void forEach(Visitor &&visitor) const
+    {
+        forEachIn(table_, visitor);
+        forEachIn(old_, visitor);
+    }
+
+private:
+    using Traits = KeyTraits<Key>;
+
+    struct Slot
+    {
+        typename Traits::Stored key;
+        uint32_t size;     // TOMBSTONE_SIZE 表示墓碑
+        uint64_t location; // segment_id << 40 | offset
+    };
+    static constexpr uint32_t TOMBSTONE_SIZE = UINT32_MAX;
+    static constexpr size_t INLINE_VALUE_OVERHEAD = 16; // 每次分配的额外开销（估计值）
+
+    struct Table
+    {
+        std::vector<int8_t> ctrl; // 每槽一个控制字：EMPTY、DELETED 或哈希低 7 位
+        std::vector<Slot> slots;
+        std::vector<std::unique_ptr<char[]>> values; // 与 slots 平行的内联 value，未启用时为空
+        size_t capacity = 0;      // 槽数，2 的幂且为组宽的整数倍
+        size_t size = 0;          // 有效槽数
+        size_t deleted = 0;       // DELETED 槽数，影响探测长度，扩容时清除
+    };
+
+    static Meta decode(const Table &table, size_t pos);
+    static void decodeLocation(const Slot &slot, Meta &meta); // 只解码位置字段，不拷贝 key
+    static void encodeLocation(Slot &slot, const Meta &meta);
+
+    static size_t findSlot(const Table &table, const Key &key, uint64_t hash); // 未找到时返回 capacity
+    static size_t insertNew(Table &table, Slot &&slot, uint64_t hash);         // 调用者保证 key 不在表中，返回槽位置
+    static void moveSlot(Table &from, size_t pos, Table &to, uint64_t hash);   // 连同内联 value 移到另一张表
+    void eraseAt(Table &table, size_t pos);
+    void allocate(Table &table, size_t capacity) const;
+    void storeValue(Table &table, size_t pos, const Meta &meta); // 替换槽的内联 value 并更新占用统计
+
+    void growIfNeeded();
+    void migrateStep(); // 从旧表迁移一批槽到新表
+    void finishMigration();
+
+    template <typename Visitor>
+    static void forEachIn(const Table &table, Visitor &visitor)
+    {
+        for (size_t i = 0; i < table.capacity; ++i)
+        {
+            if (table.ctrl[i] >= 0)
+            {
+                visitor(decode(table, i));
+            }
+        }
+    }
+
+    Table table_;        // 新插入的 key 都进入这张表
+    Table old_;          // 扩容期间尚未迁移完的旧表，否则为空
+    size_t migrate_pos_ = 0;
+    bool inline_values_ = false;
+    size_t inline_bytes_ = 0;
+};
+
+using IndexTable = BasicIndexTable<int>;
+
+#endif // INDEX_TABLE_H
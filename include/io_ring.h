@@ -0,0 +1,99 @@
+#ifndef IO_RING_H
+#define IO_RING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+// 基于 io_uring 的异步定位读写，直接使用系统调用，不依赖 liburing。
+// 提交不阻塞调用线程（除非在途请求已达上限），完成回调在内部的完成线程上执行。
+// 内核不支持、被禁用或不支持所需的操作码（5.6 之前的内核）时 available() 返回 false，
+// 由调用者回退到同步 I/O。等待完成事件出现无法恢复的错误时，在途请求全部以 -EIO 完成，
+// 此后 available() 返回 false。
+class IoRing
+{
+public:
+    // 参数为完成时的返回值：成功为传输的字节数，失败为 -errno
+    using Completion = std::function<void(int)>;
+
+    // 链式提交中的一个请求：buf 为 nullptr 时是对 fd 的 fdatasync，否则是定位写
+    struct LinkedWrite
+    {
+        int fd;
+        const char *buf;
+        size_t size;
+        uint64_t offset;
+    };
+
+    explicit IoRing(unsigned entries = 256);
+    ~IoRing();
+
+    IoRing(const IoRing &) = delete;
+    IoRing &operator=(const IoRing &) = delete;
+
+    bool available() const;
+
+    // 提交异步读写，返回 false 表示未能提交（回调不会被调用），单次超过 4 GiB 的读写也不提交。
+    // 回调中可以继续提交；完成线程另有一份与队列深度相同的余量，超出时不会等待，而是返回 false
+    bool read(int fd, char *buf, size_t size, uint64_t offset, Completion completion);
+    bool write(int fd, const char *buf, size_t size, uint64_t offset, Completion completion);
+    bool fdatasync(int fd, Completion completion);
+
+    // 一次提交一组按顺序执行的写与 fdatasync（IOSQE_IO_LINK 链接），前一个失败或短写时后续请求被取消。
+    // 全部结束后回调一次：都完整完成时参数为 0，否则为第一个失败请求的 -errno（短写记为 -EIO）
+    bool writeLinked(const std::vector<LinkedWrite> &writes, Completion completion);
+
+private:
+    struct Request
+    {
+        uint8_t opcode;
+        int fd;
+        uint64_t addr;
+        uint32_t size;
+        uint64_t offset;
+        uint32_t op_flags;
+        Completion *completion; // 为 nullptr 时是唤醒完成线程的 NOP
+    };
+
+    bool submit(const Request *requests, unsigned count, bool linked = false);
+    bool submitWithCompletion(uint8_t opcode, int fd, uint64_t addr, size_t size, uint64_t offset, Completion completion, uint32_t op_flags = 0);
+    void reap();       // 完成线程主循环
+    void failPending(); // 完成线程退出前让所有在途请求以 -EIO 完成
+
+    int ring_fd_ = -1;
+    unsigned entries_ = 0;
+    unsigned cq_entries_ = 0; // 完成队列深度（提交队列的两倍），完成线程的提交以此为上限
+
+    // 内核共享的提交队列与完成队列
+    void *sq_ring_ = nullptr;
+    void *cq_ring_ = nullptr;
+    io_uring_sqe *sqes_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    size_t sqes_size_ = 0;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    io_uring_cqe *cqes_ = nullptr;
+
+    std::mutex submit_mtx_;          // 串行化 SQE 的填写与提交
+    std::condition_variable space_cv_; // 在途请求达到上限时等待
+    unsigned inflight_ = 0;          // 受 submit_mtx_ 保护
+    std::unordered_set<Completion *> pending_; // 在途请求的回调，受 submit_mtx_ 保护
+    std::atomic<bool> failed_{false};          // 完成线程已因错误退出
+    std::atomic<bool> stop_{false};
+    std::thread completion_thread_;
+};
+
+#endif // IO_RING_H
@@ -0,0 +1,183 @@
+#ifndef KEY_TRAITS_H
+#define KEY_TRAITS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// 字节串的非加密哈希：每轮把 16 字节做一次 64x64->128 位乘法混合，尾部用重叠读取补齐，
+// 短 key 只需一两次乘法
+uint64_t hashBytes(const char *data, size_t size, uint64_t seed = 0);
+
+// 64 位整数的混合函数（splitmix64 终结函数），连续的整数也能均匀分布
+inline uint64_t mixHash(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 短 key 内联存储：不超过 INLINE_CAPACITY 字节的 key 直接存放在对象内，更长的 key 才单独分配堆内存。
+// 对象共 24 字节，索引表的槽因此不会为每个短 key 额外分配一次内存
+class SmallKey
+{
+public:
+    static constexpr size_t INLINE_CAPACITY = 20;
+
+    SmallKey() = default;
+    explicit SmallKey(std::string_view key);
+    SmallKey(const SmallKey &other);
+    SmallKey(SmallKey &&other) noexcept;
+    SmallKey &operator=(const SmallKey &other);
+    SmallKey &operator=(SmallKey &&other) noexcept;
+    ~SmallKey();
+
+    size_t size() const
+    {
+        return size_;
+    }
+    bool isInline() const
+    {
+        return size_ <= INLINE_CAPACITY;
+    }
+    const char *data() const
+    {
+        return isInline() ? bytes_ : heapPointer();
+    }
+    std::string_view view() const
+    {
+        return std::string_view(data(), size_);
+    }
+
+private:
+    // 堆上的 key 把指针存放在 bytes_ 的开头
+    char *heapPointer() const
+    {
+        char *p;
+        std::memcpy(&p, bytes_, sizeof(p));
+        return p;
+    }
+    void release();
+
+    uint32_t size_ = 0;
+    char bytes_[INLINE_CAPACITY] = {};
+};
+
+// 各 key 类型在索引、日志记录与哈希上的差异都集中在 KeyTraits 中，
+// 存储层的其余代码对 key 类型一无所知
+template <typename Key>
+struct KeyTraits;
+
+// int key：记录中按 4 字节小端存放，索引槽内直接保存整数
+template <>
+struct KeyTraits<int>
+{
+    using Stored = int32_t; // 索引表槽内的存储形式
+
+    static uint64_t hash(int key)
+    {
+        return mixHash(static_cast<uint32_t>(key));
+    }
+    static uint64_t hashStored(Stored key)
+    {
+        return hash(key);
+    }
+    static bool equals(Stored stored, int key)
+    {
+        return stored == key;
+    }
+    static Stored store(int key)
+    {
+        return key;
+    }
+    static int load(Stored stored)
+    {
+        return stored;
+    }
+
+    static bool valid(int)
+    {
+        return true;
+    }
+    static size_t size(int)
+    {
+        return sizeof(int32_t);
+    }
+    static const char *data(const int &key)
+    {
+        return reinterpret_cast<const char *>(&key);
+    }
+    static bool decode(const char *data, size_t size, int &key)
+    {
+        if (size != sizeof(int32_t))
+        {
+            return false;
+        }
+        std::memcpy(&key, data, sizeof(int32_t));
+        return true;
+    }
+};
+
+// 字节串 key：长度不超过 MAX_SIZE，可以包含任意字节；有序遍历按字节的无符号字典序
+template <>
+struct KeyTraits<std::string>
+{
+    using Stored = SmallKey;
+    static constexpr size_t MAX_SIZE = UINT16_MAX;
+
+    static uint64_t hash(const std::string &key)
+    {
+        return hashBytes(key.data(), key.size());
+    }
+    static uint64_t hashStored(const Stored &key)
+    {
+        return hashBytes(key.data(), key.size());
+    }
+    static bool equals(const Stored &stored, const std::string &key)
+    {
+        return stored.view() == std::string_view(key);
+    }
+    static Stored store(const std::string &key)
+    {
+        return SmallKey(key);
+    }
+    static std::string load(const Stored &stored)
+    {
+        return std::string(stored.view());
+    }
+
+    static bool valid(const std::string &key)
+    {
+        return key.size() <= MAX_SIZE;
+    }
+    static size_t size(const std::string &key)
+    {
+        return key.size();
+    }
+    static const char *data(const std::string &key)
+    {
+        return key.data();
+    }
+    static bool decode(const char *data, size_t size, std::string &key)
+    {
+        key.assign(data, size);
+        return true;
+    }
+};
+
+// 供 std::unordered_map 等容器使用的哈希函数对象
+template <typename Key>
+struct KeyHash
+{
+    size_t operator()(const Key &key) const
+    {
+        return static_cast<size_t>(KeyTraits<Key>::hash(key));
+    }
+};
+
+#endif // KEY_TRAITS_H
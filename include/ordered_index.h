@@ -0,0 +1,66 @@
+#ifndef ORDERED_INDEX_H
+#define ORDERED_INDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// 有序的 key 集合，供范围扫描使用，只保存仍然有效（未删除）的 key。
+// 结构类似两层的 B+ 树：叶子是最多 LEAF_CAPACITY 个 key 的有序数组，
+// 叶子按首个 key 组织在平衡树中。范围遍历在叶子内顺序访问连续内存，int key 每个只占 4 字节。
+// 本身不加锁，由调用者（FileStore 的 index_mtx_）保证并发安全
+template <typename Key>
+class BasicOrderedKeyIndex
+{
+public:
+    static constexpr size_t LEAF_CAPACITY = 256;
+
+    void insert(const Key &key); // key 已存在时不做任何事
+    void erase(const Key &key);
+    void assign(const std::vector<Key> &sorted_keys); // 由升序且无重复的 key 批量构建
+    void clear();
+    size_t size() const;
+
+    // 按升序访问 [start, end) 中的 key，visitor 返回 false 时停止
+    template <typename Visitor>
+    void forRange(const Key &start, const Key &end, Visitor &&visitor) const
+    {
+        if (start >= end || leaves_.empty())
+        {
+            return;
+        }
+        auto it = leaves_.upper_bound(start);
+        if (it != leaves_.begin())
+        {
+            --it;
+        }
+        for (; it != leaves_.end() && it->first < end; ++it)
+        {
+            const std::vector<Key> &leaf = it->second;
+            auto pos = it->first < start ? std::lower_bound(leaf.begin(), leaf.end(), start) : leaf.begin();
+            for (; pos != leaf.end(); ++pos)
+            {
+                if (*pos >= end || !visitor(*pos))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+private:
+    using LeafMap = std::map<Key, std::vector<Key>>;
+    using LeafIterator = typename LeafMap::iterator;
+
+    LeafIterator findLeaf(const Key &key); // key 所属的叶子：首个 key 不大于 key 的最后一个叶子
+    void rekey(LeafIterator &it);          // 叶子的首个 key 变化后更新其在树中的位置
+
+    LeafMap leaves_; // 叶子首个 key -> 叶子
+    size_t size_ = 0;
+};
+
+using OrderedKeyIndex = BasicOrderedKeyIndex<int>;
+
+#endif // ORDERED_INDEX_H
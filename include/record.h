@@ -0,0 +1,156 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 段文件头：magic(4) | version(4) | segment_id(8)
+constexpr uint32_t DATA_FILE_MAGIC = 0x3153564B; // "KVS1"
+constexpr uint32_t DATA_FILE_VERSION = 2;
+constexpr size_t DATA_FILE_HEADER_SIZE = 16;
+
+// 记录头：checksum(4) | seq(8) | key_size(4) | value_size(4) | flags(1) | reserved(3)
+// checksum 覆盖 checksum 之后的头部字段、key 和 value。
+// int key 占 4 字节，字节串 key 按实际长度存放
+constexpr size_t RECORD_HEADER_SIZE = 24;
+constexpr size_t RECORD_KEY_SIZE = sizeof(int32_t);
+constexpr size_t RECORD_MAX_KEY_SIZE = UINT16_MAX;
+constexpr uint8_t RECORD_FLAG_TOMBSTONE = 0x1;
+constexpr uint8_t RECORD_FLAG_BATCH = 0x2;
+
+struct RecordHeader
+{
+    uint32_t checksum;
+    uint64_t seq;
+    uint32_t key_size;
+    uint32_t value_size;
+    uint8_t flags;
+};
+
+// CRC-32 (IEEE)，crc 参数用于分段累加
+uint32_t crc32(const char *data, size_t size, uint32_t crc = 0);
+
+// 一条记录在文件中占用的总字节数
+inline size_t recordSize(size_t value_size, size_t key_size = RECORD_KEY_SIZE)
+{
+    return RECORD_HEADER_SIZE + key_size + value_size;
+}
+
+// 记录中 value 相对记录起始位置的偏移
+inline size_t recordValueOffset(size_t key_size = RECORD_KEY_SIZE)
+{
+    return RECORD_HEADER_SIZE + key_size;
+}
+
+// 将一条记录编码后追加到 out 末尾
+void appendRecord(std::string &out, const char *key, size_t key_size, const char *value, size_t value_size, uint64_t seq, uint8_t flags);
+
+// 批次帧：头部与普通记录相同，flags 为 RECORD_FLAG_BATCH、key 为空，value 是连续编码的内部记录。
+// 帧的 checksum 覆盖全部内部记录，帧不完整或损坏时整批都不会被恢复；索引直接指向内部记录
+size_t beginBatchRecord(std::string &out); // 预留帧头，返回帧在 out 中的起始位置
+void finishBatchRecord(std::string &out, size_t frame_start, uint64_t seq); // 内部记录追加完后回填帧头
+
+// 解析 data 起始处的一条记录，available 为缓冲区中可用的字节数，key 位于 data + RECORD_HEADER_SIZE
+// 返回 1 表示成功，0 表示数据不足（记录被截断），-1 表示记录损坏
+int parseRecord(const char *data, size_t available, RecordHeader &header);
+
+// 段文件头编解码
+void encodeFileHeader(char *out, uint64_t segment_id);
+bool decodeFileHeader(const char *data, uint64_t &segment_id);
+
+// 检查点（索引文件）：紧凑的定长格式，与内存结构的布局无关，可一次读入后批量解码
+// 文件头：magic(4) | version(4) | entry_count(8) | active_segment(8) | log_end(8) | next_segment_id(8) | next_seq(8)
+//         | blob_segment(8) | blob_log_end(8)
+// 索引项：key(4) | segment_id(4) | offset(8) | value_size(4) | flags(1)
+// 版本 3 在文件头中加入了当前 blob 文件的位置，更早版本的检查点不再识别，启动时从段重建索引
+// 文件尾：覆盖文件头与全部索引项的 crc32(4)
+constexpr uint32_t INDEX_FILE_MAGIC = 0x3149564B; // "KVI1"
+constexpr uint32_t INDEX_FILE_VERSION = 3;
+constexpr size_t INDEX_FILE_HEADER_SIZE = 64;
+constexpr size_t INDEX_ENTRY_SIZE = 21;
+constexpr size_t INDEX_FILE_TRAILER_SIZE = sizeof(uint32_t);
+
+struct IndexFileHeader
+{
+    uint64_t entry_count;
+    uint64_t active_segment;  // 检查点时的当前段
+    uint64_t log_end;         // 当前段中已包含在检查点内的位置
+    uint64_t next_segment_id; // 此后创建的段需要整段重放
+    uint64_t next_seq;        // 序列号小于它的记录已包含在检查点内
+    uint64_t blob_segment;    // 检查点时的当前 blob 文件，没有时为 0
+    uint64_t blob_log_end;    // 当前 blob 文件中已包含在检查点内的位置
+};
+
+template <typename Key>
+struct BasicIndexEntry
+{
+    Key key;
+    uint32_t segment_id;
+    uint64_t offset;     // 记录起始位置
+    uint32_t value_size;
+    uint8_t flags;       // RECORD_FLAG_TOMBSTONE 表示已删除
+};
+using IndexEntry = BasicIndexEntry<int>;
+
+// 字节串 key 的检查点（版本 4）：文件头与文件尾相同，索引项按 key 升序排列并做前缀压缩，
+// 每个 key 只记录与前一个 key 不同的后缀
+// 索引项：shared_size(varint) | suffix_size(varint) | suffix | segment_id(4) | offset(8) | value_size(4) | flags(1)
+constexpr uint32_t INDEX_FILE_VERSION_BYTE_KEYS = 4;
+
+// 检查点编解码：encode 写入 INDEX_FILE_HEADER_SIZE / INDEX_ENTRY_SIZE 字节；
+// decodeIndexHeader 校验 magic、版本，定长格式还校验文件长度与索引项数是否一致
+void encodeIndexHeader(char *out, const IndexFileHeader &header, uint32_t version = INDEX_FILE_VERSION);
+bool decodeIndexHeader(const char *data, size_t file_size, IndexFileHeader &header, uint32_t version = INDEX_FILE_VERSION);
+void encodeIndexEntry(char *out, const IndexEntry &entry);
+void decodeIndexEntry(const char *data, IndexEntry &entry);
+bool decodeIndexEntry(const char *&p, const char *end, IndexEntry &entry); // 按游标解码，越界时返回 false
+
+// 版本 4 的索引项：prev_key 为前一项的 key（第一项为空串）；
+// 解码时 entry.key 传入前一项的 key、返回本项的 key，p 前进到下一项，越界或格式错误时返回 false
+void appendIndexEntry(std::string &out, const BasicIndexEntry<std::string> &entry, const std::string &prev_key);
+bool decodeIndexEntry(const char *&p, const char *end, BasicIndexEntry<std::string> &entry);
+
+// 提示文件（<段文件>.hint）：段中每条记录的位置与序列号，恢复时代替扫描整个段，无需读取 value
+// 文件头：magic(4) | version(4) | segment_id(8) | data_end(8) | min_seq(8) | entry_count(8)
+// 提示项：key(4) | offset(8) | value_size(4) | seq(8) | flags(1)
+// 文件尾：覆盖文件头与全部提示项的 crc32(4)
+constexpr uint32_t HINT_FILE_MAGIC = 0x3148564B; // "KVH1"
+constexpr uint32_t HINT_FILE_VERSION = 1;
+constexpr size_t HINT_FILE_HEADER_SIZE = 40;
+constexpr size_t HINT_ENTRY_SIZE = 25;
+constexpr size_t HINT_FILE_TRAILER_SIZE = sizeof(uint32_t);
+
+struct HintFileHeader
+{
+    uint64_t segment_id;
+    uint64_t data_end; // 提示覆盖到的段大小，与段文件大小一致时才可信
+    uint64_t min_seq;  // 段中记录的最小序列号
+    uint64_t entry_count;
+};
+
+template <typename Key>
+struct BasicHintEntry
+{
+    Key key;
+    uint64_t offset; // 记录起始位置
+    uint32_t value_size;
+    uint64_t seq;
+    uint8_t flags;
+};
+using HintEntry = BasicHintEntry<int>;
+
+// 字节串 key 的提示文件（版本 2），文件头与文件尾相同
+// 提示项：key_size(2) | key | offset(8) | value_size(4) | seq(8) | flags(1)
+constexpr uint32_t HINT_FILE_VERSION_BYTE_KEYS = 2;
+
+// 提示文件编解码，格式与检查点相同：一次读入后批量解码。
+// decodeHintEntry 从 p 解码一项并前进，越界或格式错误时返回 false
+void encodeHintHeader(char *out, const HintFileHeader &header, uint32_t version = HINT_FILE_VERSION);
+bool decodeHintHeader(const char *data, size_t file_size, HintFileHeader &header, uint32_t version = HINT_FILE_VERSION);
+void appendHintEntry(std::string &out, const HintEntry &entry);
+bool decodeHintEntry(const char *&p, const char *end, HintEntry &entry);
+void appendHintEntry(std::string &out, const BasicHintEntry<std::string> &entry);
+bool decodeHintEntry(const char *&p, const char *end, BasicHintEntry<std::string> &entry);
+
+#endif // RECORD_H
@@ -0,0 +1,68 @@
+#ifndef SHARDED_STORE_H
+#define SHARDED_STORE_H
+
+#include "file_store.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+
+// 按 key 的哈希把请求路由到 N 个相互独立的 FileStore 分片。
+// 每个分片有自己的段文件、索引、锁与 GC 线程，写入可随核数扩展，压缩一次只影响一个分片。
+// 分片数写入 <storage_file>.shards，重新打开时以文件中记录的分片数为准，避免 key 被路由到错误的分片。
+template <typename Key>
+class BasicShardedFileStore
+{
+public:
+    using Store = BasicFileStore<Key>;
+    using ScanEntry = BasicScanEntry<Key>;
+
+    BasicShardedFileStore(const std::string &file_path, size_t shard_count = 1, bool clean_start = false,
+                          const FileStoreOptions &options = FileStoreOptions());
+
+    BasicShardedFileStore(const BasicShardedFileStore &) = delete;
+    BasicShardedFileStore &operator=(const BasicShardedFileStore &) = delete;
+
+    bool put(const Key &key, const std::string &value);
+    std::string get(const Key &key);
+    bool del(const Key &key);
+
+    void asyncGet(const Key &key, std::function<void(std::string)> callback);
+    void asyncPut(const Key &key, const std::string &value, std::function<void(bool)> callback);
+    void asyncDel(const Key &key, std::function<void(bool)> callback);
+    bool hasAsyncIo() const;
+
+    // 批量接口：按分片拆分后每个分片各执行一次批量读写，结果按 keys 的顺序返回。
+    // 每个分片内的写入是一个批次，多个分片之间不保证原子性
+    std::vector<std::string> multiGet(std::span<const Key> keys);
+    void asyncMultiGet(std::span<const Key> keys, std::function<void(std::vector<std::string>)> callback);
+    bool multiPut(std::span<const std::pair<Key, std::string>> items);
+    void asyncMultiPut(std::span<const std::pair<Key, std::string>> items, std::function<void(bool)> callback);
+
+    // 原子批次：按分片拆分，每个分片内原子地应用；只有一个分片时整批原子
+    bool write(const BasicWriteBatch<Key> &batch);
+    void asyncWrite(const BasicWriteBatch<Key> &batch, std::function<void(bool)> callback);
+
+    // 范围扫描：合并各分片的结果，按 key 升序返回 [start, end) 中最多 limit 个对象
+    std::vector<ScanEntry> scan(const Key &start, const Key &end, size_t limit = SIZE_MAX);
+
+    bool sync();                         // 同步所有分片
+    size_t getSyncCount() const;         // 所有分片之和
+
+    size_t getReadCount() const;         // 所有分片之和
+    size_t getCommitBatchCount() const;  // 所有分片之和
+    size_t garbageCollect();             // 依次压缩各分片，返回回收的总字节数
+    size_t shardCount() const;
+    Store &shard(size_t index);          // 直接访问某个分片（统计与测试用）
+    size_t shardFor(const Key &key) const; // key 所在的分片
+
+private:
+    std::vector<BasicWriteBatch<Key>> splitBatch(const BasicWriteBatch<Key> &batch) const; // 按分片拆分批次，保持操作顺序
+
+    std::vector<std::unique_ptr<Store>> shards_;
+};
+
+using ShardedFileStore = BasicShardedFileStore<int>;
+using StringShardedFileStore = BasicShardedFileStore<std::string>;
+
+#endif // SHARDED_STORE_H
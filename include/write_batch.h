@@ -0,0 +1,39 @@
+#ifndef WRITE_BATCH_H
+#define WRITE_BATCH_H
+
+#include <string>
+#include <vector>
+#include "key_traits.h"
+
+// 原子写入批次：累积一组 put / del，由 write 一次性应用。
+// 整批编码为一个批次帧追加到日志，并在一次索引临界区内发布：读者要么看到全部修改，要么一个也看不到，
+// 崩溃恢复时不完整的帧整体丢弃。同一 key 在批次中出现多次时以最后一次为准
+template <typename Key>
+class BasicWriteBatch
+{
+public:
+    struct Operation
+    {
+        Key key;
+        std::string value;
+        bool tombstone = false;
+    };
+
+    void put(const Key &key, const std::string &value);
+    void del(const Key &key);
+    void clear();
+
+    size_t count() const;
+    bool empty() const;
+    size_t valueBytes() const; // 所有 value 的总字节数
+    const std::vector<Operation> &operations() const;
+
+private:
+    std::vector<Operation> operations_;
+    size_t value_bytes_ = 0;
+};
+
+using WriteBatch = BasicWriteBatch<int>;
+using StringWriteBatch = BasicWriteBatch<std::string>;
+
+#endif // WRITE_BATCH_H
@@ -1,101 +1,656 @@
 #include "cache.h"
 #include <functional>
 #include <memory> // 添加此头文件以使用std::make_unique
+#include <algorithm>
+#include <type_traits>
+#include <thread>
 
-// 构造函数
-LRUCacheSegment::LRUCacheSegment(size_t capacity) : capacity_(capacity) {}
+// 每行的宽度取不小于 4 倍估计项数的 2 的幂，减少大量一次性 key 碰撞造成的高估；
+// 减半周期仍按估计项数的 10 倍计算
+CountMinSketch::CountMinSketch(size_t entries)
+{
+    entries = std::max<size_t>(entries, 16);
+    size_t w = 64;
+    while (w < 4 * entries && w < (size_t(1) << 22))
+    {
+        w <<= 1;
+    }
+    mask_ = w - 1;
+    sample_size_ = 10 * entries;
+    counters_ = std::vector<std::atomic<uint8_t>>(ROWS * w);
+}
 
-// 获取缓存中的值
-bool LRUCacheSegment::get(int key, std::string &value)
+// 对 key 哈希再混合一次，避免与段内哈希表的取位相关，各行用双重哈希取不同的位置
+size_t CountMinSketch::index(uint64_t hash, size_t row) const
+{
+    uint64_t h = mixHash(hash + 0x9e3779b97f4a7c15ULL);
+    uint64_t step = (h >> 32) | 1;
+    return row * (mask_ + 1) + ((h + row * step) & mask_);
+}
+
+void CountMinSketch::increment(uint64_t hash)
 {
-    std::lock_guard<std::mutex> lock(mtx_);
-    auto it = cache_map_.find(key);
-    if (it == cache_map_.end())
+    for (size_t row = 0; row < ROWS; ++row)
+    {
+        auto &counter = counters_[index(hash, row)];
+        uint8_t count = counter.load(std::memory_order_relaxed);
+        if (count < MAX_COUNT)
+        {
+            counter.store(count + 1, std::memory_order_relaxed);
+        }
+    }
+    if (additions_.fetch_add(1, std::memory_order_relaxed) + 1 == sample_size_)
+    {
+        age();
+    }
+}
+
+uint8_t CountMinSketch::estimate(uint64_t hash) const
+{
+    uint8_t min = MAX_COUNT;
+    for (size_t row = 0; row < ROWS; ++row)
+    {
+        min = std::min(min, counters_[index(hash, row)].load(std::memory_order_relaxed));
+    }
+    return min;
+}
+
+// 只有使累计计数恰好到达阈值的线程执行减半
+void CountMinSketch::age()
+{
+    for (auto &counter : counters_)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+    }
+    additions_.store(sample_size_ / 2, std::memory_order_relaxed);
+}
+
+template <typename Key>
+BasicClockCacheSegment<Key>::BasicClockCacheSegment(size_t capacity, size_t budget, bool count_hits, const CacheOptions &options)
+    : table_(new Table(16)), capacity_(capacity), budget_(budget), count_hits_(count_hits), admission_(options.admission),
+      window_ratio_(options.window_ratio)
+{
+    if (admission_)
+    {
+        // sketch 按段能容纳的项数设定大小：只限字节时按每项 64 字节估算
+        size_t entries = capacity != 0 ? capacity : (budget == SIZE_MAX ? 0 : budget / 64);
+        sketch_ = std::make_unique<CountMinSketch>(entries);
+    }
+}
+
+template <typename Key>
+BasicClockCacheSegment<Key>::~BasicClockCacheSegment()
+{
+    for (Slot &slot : slots_)
+    {
+        delete slot.entry;
+    }
+    delete table_.load(std::memory_order_relaxed);
+}
+
+// 每项计入 value 缓冲区（含 make_shared 合并分配的控制块）、key 的堆内存，
+// 以及槽、缓存项和表中桶（负载不超过一半，按两个桶计）的固定开销
+template <typename Key>
+size_t BasicClockCacheSegment<Key>::entryCharge(const Key &key, const std::string &value)
+{
+    size_t charge = sizeof(Slot) + sizeof(Entry) + 2 * sizeof(void *) +
+                    sizeof(std::string) + 2 * sizeof(void *) + value.size();
+    if constexpr (std::is_same_v<Key, std::string>)
+    {
+        // 字节串 key 超出短字符串的内联容量时有一次堆分配
+        if (key.size() >= sizeof(std::string))
+        {
+            charge += key.size() + 1;
+        }
+    }
+    return charge;
+}
+
+template <typename Key>
+typename BasicClockCacheSegment<Key>::Entry *BasicClockCacheSegment<Key>::tombstone()
+{
+    static Entry sentinel{};
+    return &sentinel;
+}
+
+// 从哈希的低位开始线性探测，遇到空桶结束；墓碑与其他 key 的缓存项跳过
+template <typename Key>
+typename BasicClockCacheSegment<Key>::Entry *BasicClockCacheSegment<Key>::find(const Key &key, uint64_t hash) const
+{
+    const Table *table = table_.load(std::memory_order_acquire);
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask)
+    {
+        Entry *entry = table->buckets[i].load(std::memory_order_acquire);
+        if (entry == nullptr)
+        {
+            return nullptr;
+        }
+        if (entry != tombstone() && entry->hash == hash && entry->key == key)
+        {
+            return entry;
+        }
+    }
+}
+
+// 新项占用探测链上的第一个空桶或墓碑；调用者保证 key 不在表中
+template <typename Key>
+void BasicClockCacheSegment<Key>::link(Entry *entry)
+{
+    Table *table = table_.load(std::memory_order_relaxed);
+    if ((entries_ + tombstones_ + 1) * 2 > table->mask + 1)
+    {
+        size_t size = 16;
+        while (size < 4 * (entries_ + 1))
+        {
+            size <<= 1;
+        }
+        rebuild(size);
+        table = table_.load(std::memory_order_relaxed);
+    }
+    for (size_t i = entry->hash & table->mask;; i = (i + 1) & table->mask)
+    {
+        Entry *current = table->buckets[i].load(std::memory_order_relaxed);
+        if (current == nullptr || current == tombstone())
+        {
+            tombstones_ -= current == tombstone();
+            table->buckets[i].store(entry, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+template <typename Key>
+void BasicClockCacheSegment<Key>::unlink(Entry *entry)
+{
+    Table *table = table_.load(std::memory_order_relaxed);
+    for (size_t i = entry->hash & table->mask;; i = (i + 1) & table->mask)
+    {
+        if (table->buckets[i].load(std::memory_order_relaxed) == entry)
+        {
+            table->buckets[i].store(tombstone(), std::memory_order_release);
+            tombstones_++;
+            return;
+        }
+    }
+}
+
+// 新表填好后才发布，读者看到的总是完整的表；旧表等到读者离开后释放
+template <typename Key>
+void BasicClockCacheSegment<Key>::rebuild(size_t size)
+{
+    auto *table = new Table(size);
+    for (const Slot &slot : slots_)
+    {
+        if (!slot.entry)
+        {
+            continue;
+        }
+        size_t i = slot.entry->hash & table->mask;
+        while (table->buckets[i].load(std::memory_order_relaxed) != nullptr)
+        {
+            i = (i + 1) & table->mask;
+        }
+        table->buckets[i].store(slot.entry, std::memory_order_relaxed);
+    }
+    retired_.retire(table_.exchange(table, std::memory_order_acq_rel));
+    tombstones_ = 0;
+}
+
+// 获取缓存中的值：只取得缓冲区的引用，复制在临界区外进行
+template <typename Key>
+bool BasicClockCacheSegment<Key>::get(const Key &key, std::string &value)
+{
+    SharedValue shared;
+    if (!get(key, shared))
+    {
+        return false;
+    }
+    value = *shared;
+    return true;
+}
+
+// 不加锁：纪元临界区保证探测到的缓存项与表在读取期间不被释放，命中时置位访问标记并增加缓冲区的引用计数
+template <typename Key>
+bool BasicClockCacheSegment<Key>::get(const Key &key, SharedValue &value)
+{
+    uint64_t hash = KeyTraits<Key>::hash(key);
+    EpochGuard guard;
+    Entry *entry = find(key, hash);
+    if (!entry)
     {
         return false;
     }
-    // 移动到链表头部
-    cache_list_.splice(cache_list_.begin(), cache_list_, it->second);
-    value = it->second->second;
+    // 已置位时不再写入，热点项所在的缓存行不会在读者之间来回失效
+    if (!entry->referenced.load(std::memory_order_relaxed))
+    {
+        entry->referenced.store(true, std::memory_order_relaxed);
+    }
+    if (count_hits_)
+    {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (admission_)
+    {
+        sketch_->increment(hash);
+    }
+    value = entry->value;
     return true;
 }
 
 // 添加或更新缓存中的值
-void LRUCacheSegment::put(int key, const std::string &value)
+template <typename Key>
+void BasicClockCacheSegment<Key>::put(const Key &key, SharedValue value)
+{
+    size_t charge = entryCharge(key, *value);
+    uint64_t hash = KeyTraits<Key>::hash(key);
+    auto lock = lockExclusive();
+    size_t budget = budget_.load(std::memory_order_relaxed);
+
+    // 更新时先移除旧项再按新的大小重新计费，被更新的项保持已访问
+    bool referenced = false;
+    if (Entry *old = find(key, hash))
+    {
+        release(old->pos);
+        referenced = true;
+    }
+    if (charge > budget)
+    {
+        return;
+    }
+    if (admission_)
+    {
+        insertWithAdmission(key, hash, std::move(value), charge, referenced);
+        return;
+    }
+
+    // 新项的访问标记为 0：只被访问一次的项在指针下一次经过时即被淘汰
+    while (entries_ > 0 && (bytes_.load(std::memory_order_relaxed) + charge > budget || (capacity_ != 0 && entries_ >= capacity_)))
+    {
+        evict();
+    }
+    insertEntry(key, hash, std::move(value), charge, referenced);
+}
+
+// 分配槽并发布新的缓存项，读者此后即可命中
+template <typename Key>
+size_t BasicClockCacheSegment<Key>::insertEntry(const Key &key, uint64_t hash, SharedValue value, size_t charge, bool referenced)
+{
+    size_t pos = allocateSlot();
+    auto *entry = new Entry{key, std::move(value), hash, pos, referenced};
+    link(entry); // 先加入表再放入槽：加入时若重建表，新表只包含已有的缓存项
+    Slot &slot = slots_[pos];
+    slot.entry = entry;
+    slot.charge = charge;
+    bytes_.fetch_add(charge, std::memory_order_relaxed);
+    entries_++;
+    return pos;
+}
+
+// 新项总是先进入窗口；窗口超出其份额时，最早进入的项逐个接受准入判断
+template <typename Key>
+void BasicClockCacheSegment<Key>::insertWithAdmission(const Key &key, uint64_t hash, SharedValue value, size_t charge, bool referenced)
+{
+    sketch_->increment(hash);
+
+    size_t pos = insertEntry(key, hash, std::move(value), charge, referenced);
+    slots_[pos].window = true;
+    window_.push_back(pos);
+    window_bytes_ += charge;
+
+    size_t budget = budget_.load(std::memory_order_relaxed);
+    size_t window_budget = budget == SIZE_MAX ? SIZE_MAX : static_cast<size_t>(budget * window_ratio_);
+    size_t window_capacity = capacity_ == 0 ? SIZE_MAX : std::max<size_t>(1, static_cast<size_t>(capacity_ * window_ratio_));
+    while (!window_.empty() && (window_bytes_ > window_budget || window_.size() > window_capacity))
+    {
+        size_t candidate = window_.front();
+        window_.pop_front();
+        admit(candidate);
+    }
+}
+
+// 主区有空间时直接进入；否则与主区的淘汰候选比较，候选更冷时淘汰候选，直到腾出空间或新项被拒绝。
+// 频率相同时拒绝新项，避免一次性访问的 key 挤掉主区中同样冷的项
+template <typename Key>
+void BasicClockCacheSegment<Key>::admit(size_t candidate)
 {
-    std::lock_guard<std::mutex> lock(mtx_);
-    auto it = cache_map_.find(key);
-    if (it != cache_map_.end())
+    Slot &slot = slots_[candidate];
+    size_t budget = budget_.load(std::memory_order_relaxed);
+    size_t window_capacity = capacity_ == 0 ? SIZE_MAX : std::max<size_t>(1, static_cast<size_t>(capacity_ * window_ratio_));
+    size_t main_budget = budget == SIZE_MAX ? SIZE_MAX : budget - static_cast<size_t>(budget * window_ratio_);
+    size_t main_capacity = capacity_ == 0 ? SIZE_MAX : (capacity_ > window_capacity ? capacity_ - window_capacity : 1);
+    uint8_t frequency = sketch_->estimate(slot.entry->hash);
+
+    // 候选已离开窗口队列，先从窗口的计费中移除
+    slot.window = false;
+    window_bytes_ -= slot.charge;
+    if (slot.charge > main_budget)
     {
-        // 更新值并移动到链表头部
-        it->second->second = value;
-        cache_list_.splice(cache_list_.begin(), cache_list_, it->second);
+        rejected_++;
+        release(candidate);
+        return;
     }
-    else
+    while (true)
     {
-        // 如果容量已满，移除最久未使用的项
-        if (cache_list_.size() >= capacity_)
+        // 主区的占用为总量减去窗口与候选
+        size_t main_entries = entries_ - window_.size() - 1;
+        size_t main_bytes = bytes_.load(std::memory_order_relaxed) - window_bytes_ - slot.charge;
+        if (main_entries == 0 || (main_bytes + slot.charge <= main_budget && main_entries < main_capacity))
         {
-            auto last = cache_list_.back();
-            cache_map_.erase(last.first);
-            cache_list_.pop_back();
+            break;
         }
-        // 插入新项到链表头部
-        cache_list_.emplace_front(key, value);
-        cache_map_[key] = cache_list_.begin();
+        size_t victim = clockVictim(true, candidate);
+        if (frequency <= sketch_->estimate(slots_[victim].entry->hash))
+        {
+            rejected_++;
+            release(candidate);
+            return;
+        }
+        release(victim);
     }
 }
 
+template <typename Key>
+size_t BasicClockCacheSegment<Key>::allocateSlot()
+{
+    if (!free_slots_.empty())
+    {
+        size_t pos = free_slots_.back();
+        free_slots_.pop_back();
+        return pos;
+    }
+    slots_.emplace_back();
+    return slots_.size() - 1;
+}
+
 // 删除缓存中的值
-void LRUCacheSegment::remove(int key)
+template <typename Key>
+void BasicClockCacheSegment<Key>::remove(const Key &key)
 {
-    std::lock_guard<std::mutex> lock(mtx_);
-    auto it = cache_map_.find(key);
-    if (it != cache_map_.end())
+    uint64_t hash = KeyTraits<Key>::hash(key);
+    auto lock = lockExclusive();
+    if (Entry *entry = find(key, hash))
     {
-        cache_list_.erase(it->second);
-        cache_map_.erase(it);
+        release(entry->pos);
     }
 }
 
-// LRUCache构造函数
-LRUCache::LRUCache(size_t capacity, size_t num_segments)
-    : num_segments_(num_segments)
+// 缓存项从表中摘除后交给纪元回收：仍在读取它的读者不受影响，value 缓冲区在读者离开后才释放
+template <typename Key>
+void BasicClockCacheSegment<Key>::release(size_t pos)
 {
-    size_t segment_capacity = capacity / num_segments;
-    if (segment_capacity == 0)
+    Slot &slot = slots_[pos];
+    if (slot.window)
+    {
+        window_.erase(std::find(window_.begin(), window_.end(), pos));
+        window_bytes_ -= slot.charge;
+        slot.window = false;
+    }
+    unlink(slot.entry);
+    retired_.retire(slot.entry);
+    slot.entry = nullptr;
+    entries_--;
+    bytes_.fetch_sub(slot.charge, std::memory_order_relaxed);
+    slot.charge = 0;
+    free_slots_.push_back(pos);
+}
+
+template <typename Key>
+void BasicClockCacheSegment<Key>::evict()
+{
+    release(clockVictim(false, SIZE_MAX));
+}
+
+// 指针最多转两圈：第一圈清零所有访问标记，第二圈必然找到可淘汰的项。main_only 时跳过窗口中的项，
+// 正在接受准入判断的 exclude 也不作为候选
+template <typename Key>
+size_t BasicClockCacheSegment<Key>::clockVictim(bool main_only, size_t exclude)
+{
+    while (true)
+    {
+        size_t pos = hand_;
+        hand_ = (hand_ + 1) % slots_.size();
+        Slot &slot = slots_[pos];
+        if (!slot.entry || (main_only && slot.window) || pos == exclude)
+        {
+            continue;
+        }
+        if (slot.entry->referenced.load(std::memory_order_relaxed))
+        {
+            slot.entry->referenced.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        return pos;
+    }
+}
+
+template <typename Key>
+std::unique_lock<std::mutex> BasicClockCacheSegment<Key>::lockExclusive()
+{
+    lock_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(mtx_, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+        lock_contended_.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+    }
+    return lock;
+}
+
+template <typename Key>
+void BasicClockCacheSegment<Key>::setBudget(size_t budget)
+{
+    auto lock = lockExclusive();
+    budget_.store(budget, std::memory_order_relaxed);
+    while (entries_ > 0 && bytes_.load(std::memory_order_relaxed) > budget)
+    {
+        evict();
+    }
+}
+
+template <typename Key>
+size_t BasicClockCacheSegment<Key>::takeHits()
+{
+    return hits_.exchange(0, std::memory_order_relaxed);
+}
+
+template <typename Key>
+size_t BasicClockCacheSegment<Key>::bytes() const
+{
+    return bytes_.load(std::memory_order_relaxed);
+}
+
+template <typename Key>
+CacheSegmentStats BasicClockCacheSegment<Key>::getStats() const
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+    CacheSegmentStats stats;
+    stats.entries = entries_;
+    stats.bytes = bytes_.load(std::memory_order_relaxed);
+    stats.budget = budget_.load(std::memory_order_relaxed);
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.window_entries = window_.size();
+    stats.rejected = rejected_;
+    stats.lock_acquisitions = lock_acquisitions_.load(std::memory_order_relaxed);
+    stats.lock_contended = lock_contended_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+namespace
+{
+    const size_t MIN_SEGMENT_ENTRIES = 16;
+    const size_t MIN_SEGMENT_BYTES = 64 * 1024;
+
+    // 段数取 2 的幂；自动确定时按硬件线程数，段过小时 CLOCK 的淘汰顺序失真，因此逐次减半
+    size_t segmentCount(size_t requested, size_t capacity, size_t capacity_bytes)
+    {
+        size_t wanted = requested;
+        if (wanted == 0)
+        {
+            wanted = 2 * std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        size_t count = 1;
+        while (count < wanted)
+        {
+            count <<= 1;
+        }
+        if (requested == 0)
+        {
+            while (count > 1 && ((capacity != 0 && capacity / count < MIN_SEGMENT_ENTRIES) ||
+                                 (capacity_bytes != 0 && capacity_bytes / count < MIN_SEGMENT_BYTES)))
+            {
+                count >>= 1;
+            }
+        }
+        return count;
+    }
+}
+
+// ClockCache构造函数：所有段在一次对齐分配的连续数组中原地构造
+template <typename Key>
+BasicClockCache<Key>::BasicClockCache(size_t capacity, size_t num_segments, const CacheOptions &options)
+    : num_segments_(segmentCount(num_segments, capacity, options.capacity_bytes)), segment_mask_(num_segments_ - 1), options_(options)
+{
+    size_t segment_capacity = capacity / num_segments_;
+    if (capacity != 0 && segment_capacity == 0)
     {
         segment_capacity = 1; 
     }
+    size_t segment_budget = options_.capacity_bytes == 0 ? SIZE_MAX : options_.capacity_bytes / num_segments_;
+    bool count_hits = options_.capacity_bytes != 0 && options_.rebalance_interval != 0;
+    segments_ = std::allocator<BasicClockCacheSegment<Key>>().allocate(num_segments_);
     for (size_t i = 0; i < num_segments_; ++i)
     {
-        segments_.emplace_back(std::make_unique<LRUCacheSegment>(segment_capacity));
+        std::construct_at(segments_ + i, segment_capacity, segment_budget, count_hits, options_);
     }
 }
 
-// 根据键计算段的索引
-size_t LRUCache::getSegmentIndex(int key)
+template <typename Key>
+BasicClockCache<Key>::~BasicClockCache()
+{
+    std::destroy_n(segments_, num_segments_);
+    std::allocator<BasicClockCacheSegment<Key>>().deallocate(segments_, num_segments_);
+}
+
+// 根据键计算段的索引：取哈希的高位，与段内哈希表和频率估计使用的低位相互独立
+template <typename Key>
+size_t BasicClockCache<Key>::getSegmentIndex(const Key &key)
 {
-    return std::hash<int>{}(key) % num_segments_;
+    return (KeyTraits<Key>::hash(key) >> 32) & segment_mask_;
 }
 
 // 获取缓存中的值
-bool LRUCache::get(int key, std::string &value)
+template <typename Key>
+bool BasicClockCache<Key>::get(const Key &key, std::string &value)
 {
     size_t index = getSegmentIndex(key);
-    return segments_[index]->get(key, value);
+    return segments_[index].get(key, value);
 }
 
-// 添加或更新缓存中的值
-void LRUCache::put(int key, const std::string &value)
+template <typename Key>
+bool BasicClockCache<Key>::get(const Key &key, SharedValue &value)
+{
+    size_t index = getSegmentIndex(key);
+    return segments_[index].get(key, value);
+}
+
+// 添加或更新缓存中的值：复制一份到新的不可变缓冲区
+template <typename Key>
+void BasicClockCache<Key>::put(const Key &key, const std::string &value)
+{
+    put(key, std::make_shared<const std::string>(value));
+}
+
+template <typename Key>
+void BasicClockCache<Key>::put(const Key &key, SharedValue value)
 {
     size_t index = getSegmentIndex(key);
-    segments_[index]->put(key, value);
+    segments_[index].put(key, std::move(value));
+
+    if (options_.capacity_bytes != 0 && options_.rebalance_interval != 0 &&
+        (puts_.fetch_add(1, std::memory_order_relaxed) + 1) % options_.rebalance_interval == 0)
+    {
+        rebalance();
+    }
 }
 
 // 删除缓存中的值
-void LRUCache::remove(int key)
+template <typename Key>
+void BasicClockCache<Key>::remove(const Key &key)
 {
     size_t index = getSegmentIndex(key);
-    segments_[index]->remove(key);
+    segments_[index].remove(key);
+}
+
+// 重新分配段预算：先缩小预算减少的段，再放大其余段，总占用因此始终不超过 capacity_bytes
+template <typename Key>
+void BasicClockCache<Key>::rebalance()
+{
+    std::unique_lock<std::mutex> lock(rebalance_mtx_, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+        return; // 已有线程在调整
+    }
+
+    std::vector<size_t> hits(num_segments_);
+    size_t total_hits = 0;
+    for (size_t i = 0; i < num_segments_; ++i)
+    {
+        hits[i] = segments_[i].takeHits();
+        total_hits += hits[i];
+    }
+
+    size_t floor = options_.capacity_bytes / num_segments_ / 2;
+    size_t shared = options_.capacity_bytes - floor * num_segments_;
+    std::vector<size_t> budgets(num_segments_);
+    for (size_t i = 0; i < num_segments_; ++i)
+    {
+        size_t share = total_hits == 0 ? shared / num_segments_
+                                       : static_cast<size_t>(static_cast<double>(shared) * hits[i] / total_hits);
+        budgets[i] = floor + share;
+    }
+
+    std::vector<bool> shrinking(num_segments_);
+    for (size_t i = 0; i < num_segments_; ++i)
+    {
+        shrinking[i] = budgets[i] < segments_[i].getStats().budget;
+        if (shrinking[i])
+        {
+            segments_[i].setBudget(budgets[i]);
+        }
+    }
+    for (size_t i = 0; i < num_segments_; ++i)
+    {
+        if (!shrinking[i])
+        {
+            segments_[i].setBudget(budgets[i]);
+        }
+    }
+}
+
+template <typename Key>
+size_t BasicClockCache<Key>::memoryUsage() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < num_segments_; ++i)
+    {
+        total += segments_[i].bytes();
+    }
+    return total;
 }
+
+template <typename Key>
+std::vector<CacheSegmentStats> BasicClockCache<Key>::getSegmentStats() const
+{
+    std::vector<CacheSegmentStats> stats;
+    stats.reserve(num_segments_);
+    for (size_t i = 0; i < num_segments_; ++i)
+    {
+        stats.push_back(segments_[i].getStats());
+    }
+    return stats;
+}
+
+template class BasicClockCacheSegment<int>;
+template class BasicClockCacheSegment<std::string>;
+template class BasicClockCache<int>;
+template class BasicClockCache<std::string>;
@@ -2,24 +2,33 @@
 #include "engine.h"
 #include <iostream>
 
-StorageEngine::StorageEngine(const std::string &storage_file, size_t thread_pool_size, size_t cache_capacity, size_t cache_num_segments)
-    : thread_pool_(thread_pool_size), file_store_(std::make_unique<FileStore>(storage_file)), cache_(cache_capacity, cache_num_segments)
+template <typename Key>
+BasicStorageEngine<Key>::BasicStorageEngine(const std::string &storage_file, size_t thread_pool_size, size_t cache_capacity, size_t cache_num_segments,
+                                            size_t shard_count, const FileStoreOptions &store_options, const CacheOptions &cache_options)
+    : thread_pool_(thread_pool_size), file_store_(std::make_unique<BasicShardedFileStore<Key>>(storage_file, shard_count, false, store_options)),
+      cache_(cache_capacity, cache_num_segments, cache_options)
 {
 }
 
-StorageEngine::~StorageEngine()
+template <typename Key>
+BasicStorageEngine<Key>::~BasicStorageEngine()
 {
     stop();                      // 不再提交新任务
     thread_pool_.waitAllTasks(); // 等待所有已提交任务执行完毕
 }
 
-void StorageEngine::stop()
+template <typename Key>
+void BasicStorageEngine<Key>::stop()
 {
     stopped_ = true;
 }
 
-// 异步方法
-void StorageEngine::asyncPut(int key, const std::string &value, std::function<void(bool)> callback)
+// 异步方法：FileStore 支持 io_uring 时直接提交异步 I/O，不占用线程池的工作线程；
+// 在途请求计入线程池的任务数，waitAllTasks 因此也会等待它们完成。
+// 完成线程上只更新缓存，用户回调交给线程池执行：完成线程可能持有提交令牌，
+// 也负责推进后续的异步批次，回调中再调用同步读写接口会在完成线程上永久阻塞
+template <typename Key>
+void BasicStorageEngine<Key>::asyncPut(const Key &key, const std::string &value, std::function<void(bool)> callback)
 {
     if (stopped_)
     {
@@ -27,6 +36,20 @@ void StorageEngine::asyncPut(int key, const std::string &value, std::function<vo
             callback(false);
         return;
     }
+    if (file_store_->hasAsyncIo())
+    {
+        thread_pool_.incrementTasksCount();
+        file_store_->asyncPut(key, value, [this, key, value, callback](bool success)
+                              {
+            if (success) {
+                cache_.put(key, value);
+            }
+            if (callback) {
+                thread_pool_.submit([callback, success]() { callback(success); });
+            }
+            thread_pool_.decrementTasksCount(); });
+        return;
+    }
     thread_pool_.submit([this, key, value, callback]()
                         {
         bool success = put(key, value);
@@ -35,21 +58,87 @@ void StorageEngine::asyncPut(int key, const std::string &value, std::function<vo
         } });
 }
 
-void StorageEngine::asyncGet(int key, std::function<void(std::string)> callback)
+template <typename Key>
+void BasicStorageEngine<Key>::asyncGet(const Key &key, std::function<void(std::string)> callback)
 {
     if (stopped_)
     {
         return;
     }
+    if (file_store_->hasAsyncIo())
+    {
+        std::string value;
+        if (cache_.get(key, value))
+        {
+            // 缓存命中不访问磁盘，回调同样交给线程池
+            if (callback)
+                thread_pool_.submit([callback, value = std::move(value)]() mutable { callback(std::move(value)); });
+            return;
+        }
+        thread_pool_.incrementTasksCount();
+        file_store_->asyncGet(key, [this, key, callback](std::string fetched)
+                              {
+            // 读到的 value 只包装一次放入缓存，回调拿到的是该缓冲区的唯一一份副本
+            SharedValue value;
+            if (!fetched.empty()) {
+                value = std::make_shared<const std::string>(std::move(fetched));
+                cache_.put(key, value);
+            }
+            if (callback) {
+                thread_pool_.submit([callback, value]() { callback(value ? *value : std::string()); });
+            }
+            thread_pool_.decrementTasksCount(); });
+        return;
+    }
     thread_pool_.submit([this, key, callback]()
                         {
         std::string value = get(key);
         if (callback) {
-            callback(value);
+            callback(std::move(value));
+        } });
+}
+
+template <typename Key>
+void BasicStorageEngine<Key>::asyncGetShared(const Key &key, std::function<void(SharedValue)> callback)
+{
+    if (stopped_)
+    {
+        return;
+    }
+    if (file_store_->hasAsyncIo())
+    {
+        SharedValue value;
+        if (cache_.get(key, value))
+        {
+            // 缓存命中不访问磁盘，回调同样交给线程池
+            if (callback)
+                thread_pool_.submit([callback, value = std::move(value)]() mutable { callback(std::move(value)); });
+            return;
+        }
+        thread_pool_.incrementTasksCount();
+        file_store_->asyncGet(key, [this, key, callback](std::string fetched)
+                              {
+            SharedValue value;
+            if (!fetched.empty()) {
+                value = std::make_shared<const std::string>(std::move(fetched));
+                cache_.put(key, value);
+            }
+            if (callback) {
+                thread_pool_.submit([callback, value = std::move(value)]() mutable { callback(std::move(value)); });
+            }
+            thread_pool_.decrementTasksCount(); });
+        return;
+    }
+    thread_pool_.submit([this, key, callback]()
+                        {
+        SharedValue value = getShared(key);
+        if (callback) {
+            callback(std::move(value));
         } });
 }
 
-void StorageEngine::asyncDel(int key, std::function<void(bool)> callback)
+template <typename Key>
+void BasicStorageEngine<Key>::asyncDel(const Key &key, std::function<void(bool)> callback)
 {
     if (stopped_)
     {
@@ -57,6 +146,18 @@ void StorageEngine::asyncDel(int key, std::function<void(bool)> callback)
             callback(false);
         return;
     }
+    if (file_store_->hasAsyncIo())
+    {
+        cache_.remove(key);
+        thread_pool_.incrementTasksCount();
+        file_store_->asyncDel(key, [this, callback](bool success)
+                              {
+            if (callback) {
+                thread_pool_.submit([callback, success]() { callback(success); });
+            }
+            thread_pool_.decrementTasksCount(); });
+        return;
+    }
     thread_pool_.submit([this, key, callback]()
                         {
         bool success = del(key);
@@ -65,7 +166,8 @@ void StorageEngine::asyncDel(int key, std::function<void(bool)> callback)
         } });
 }
 
-bool StorageEngine::put(int key, const std::string &value)
+template <typename Key>
+bool BasicStorageEngine<Key>::put(const Key &key, const std::string &value)
 {
     // 调用底层存储
     if (!file_store_->put(key, value))
@@ -78,7 +180,8 @@ bool StorageEngine::put(int key, const std::string &value)
     return true;
 }
 
-std::string StorageEngine::get(int key)
+template <typename Key>
+std::string BasicStorageEngine<Key>::get(const Key &key)
 {
     std::string value;
     if (cache_.get(key, value))
@@ -94,18 +197,248 @@ std::string StorageEngine::get(int key)
     return value;
 }
 
-bool StorageEngine::del(int key)
+template <typename Key>
+SharedValue BasicStorageEngine<Key>::getShared(const Key &key)
+{
+    SharedValue value;
+    if (cache_.get(key, value))
+    {
+        return value; // 缓存命中
+    }
+    std::string fetched = file_store_->get(key);
+    if (fetched.empty())
+    {
+        return nullptr;
+    }
+    value = std::make_shared<const std::string>(std::move(fetched));
+    cache_.put(key, value); // 缓存与调用者共用同一个缓冲区
+    return value;
+}
+
+template <typename Key>
+std::vector<std::string> BasicStorageEngine<Key>::multiGet(std::span<const Key> keys)
+{
+    std::vector<std::string> values(keys.size());
+    std::vector<Key> misses;
+    std::vector<size_t> miss_slots;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        if (!cache_.get(keys[i], values[i]))
+        {
+            misses.push_back(keys[i]);
+            miss_slots.push_back(i);
+        }
+    }
+    if (misses.empty())
+    {
+        return values;
+    }
+    std::vector<std::string> fetched = file_store_->multiGet(misses);
+    for (size_t j = 0; j < fetched.size(); ++j)
+    {
+        if (!fetched[j].empty())
+        {
+            cache_.put(misses[j], fetched[j]);
+        }
+        values[miss_slots[j]] = std::move(fetched[j]);
+    }
+    return values;
+}
+
+template <typename Key>
+bool BasicStorageEngine<Key>::multiPut(std::span<const std::pair<Key, std::string>> items)
+{
+    bool ok = file_store_->multiPut(items);
+    for (const auto &item : items)
+    {
+        // 分片之间不保证原子性，失败时部分分片可能已写入，直接使缓存失效
+        if (ok)
+        {
+            cache_.put(item.first, item.second);
+        }
+        else
+        {
+            cache_.remove(item.first);
+        }
+    }
+    return ok;
+}
+
+template <typename Key>
+void BasicStorageEngine<Key>::asyncMultiGet(std::span<const Key> keys, std::function<void(std::vector<std::string>)> callback)
+{
+    if (stopped_)
+    {
+        return;
+    }
+    if (!file_store_->hasAsyncIo())
+    {
+        thread_pool_.submit([this, keys = std::vector<Key>(keys.begin(), keys.end()), callback]()
+                            {
+            std::vector<std::string> values = multiGet(keys);
+            if (callback) {
+                callback(std::move(values));
+            } });
+        return;
+    }
+
+    // 缓存命中的部分在调用线程上填好，只为未命中的 key 提交异步读
+    auto values = std::make_shared<std::vector<std::string>>(keys.size());
+    auto misses = std::make_shared<std::vector<Key>>();
+    auto miss_slots = std::make_shared<std::vector<size_t>>();
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        if (!cache_.get(keys[i], (*values)[i]))
+        {
+            misses->push_back(keys[i]);
+            miss_slots->push_back(i);
+        }
+    }
+    if (misses->empty())
+    {
+        // 全部命中时不访问磁盘，回调同样交给线程池
+        if (callback)
+            thread_pool_.submit([callback, values]() { callback(std::move(*values)); });
+        return;
+    }
+    thread_pool_.incrementTasksCount();
+    file_store_->asyncMultiGet(*misses, [this, values, misses, miss_slots, callback](std::vector<std::string> fetched)
+                               {
+        for (size_t j = 0; j < fetched.size(); ++j) {
+            if (!fetched[j].empty()) {
+                cache_.put((*misses)[j], fetched[j]);
+            }
+            (*values)[(*miss_slots)[j]] = std::move(fetched[j]);
+        }
+        if (callback) {
+            thread_pool_.submit([callback, values]() { callback(std::move(*values)); });
+        }
+        thread_pool_.decrementTasksCount(); });
+}
+
+template <typename Key>
+void BasicStorageEngine<Key>::asyncMultiPut(std::span<const std::pair<Key, std::string>> items, std::function<void(bool)> callback)
+{
+    if (stopped_)
+    {
+        if (callback)
+            callback(false);
+        return;
+    }
+    auto owned = std::make_shared<std::vector<std::pair<Key, std::string>>>(items.begin(), items.end());
+    if (!file_store_->hasAsyncIo())
+    {
+        thread_pool_.submit([this, owned, callback]()
+                            {
+            bool success = multiPut(*owned);
+            if (callback) {
+                callback(success);
+            } });
+        return;
+    }
+    thread_pool_.incrementTasksCount();
+    file_store_->asyncMultiPut(*owned, [this, owned, callback](bool success)
+                               {
+        for (const auto &item : *owned) {
+            if (success) {
+                cache_.put(item.first, item.second);
+            } else {
+                cache_.remove(item.first);
+            }
+        }
+        if (callback) {
+            thread_pool_.submit([callback, success]() { callback(success); });
+        }
+        thread_pool_.decrementTasksCount(); });
+}
+
+// 批次写入后让涉及的缓存项失效而不是逐个填入：批次中往往有大量不会马上读取的 key
+template <typename Key>
+bool BasicStorageEngine<Key>::write(const BasicWriteBatch<Key> &batch)
+{
+    bool ok = file_store_->write(batch);
+    for (const auto &op : batch.operations())
+    {
+        cache_.remove(op.key);
+    }
+    return ok;
+}
+
+template <typename Key>
+void BasicStorageEngine<Key>::asyncWrite(const BasicWriteBatch<Key> &batch, std::function<void(bool)> callback)
+{
+    if (stopped_)
+    {
+        if (callback)
+            callback(false);
+        return;
+    }
+    auto owned = std::make_shared<BasicWriteBatch<Key>>(batch);
+    if (!file_store_->hasAsyncIo())
+    {
+        thread_pool_.submit([this, owned, callback]()
+                            {
+            bool success = write(*owned);
+            if (callback) {
+                callback(success);
+            } });
+        return;
+    }
+    thread_pool_.incrementTasksCount();
+    file_store_->asyncWrite(*owned, [this, owned, callback](bool success)
+                            {
+        for (const auto &op : owned->operations()) {
+            cache_.remove(op.key);
+        }
+        if (callback) {
+            thread_pool_.submit([callback, success]() { callback(success); });
+        }
+        thread_pool_.decrementTasksCount(); });
+}
+
+template <typename Key>
+std::vector<BasicScanEntry<Key>> BasicStorageEngine<Key>::scan(const Key &start, const Key &end, size_t limit)
+{
+    // 缓存采用写穿透，存储中的数据总是最新的；扫描结果不放入缓存，避免冲掉热点数据
+    return file_store_->scan(start, end, limit);
+}
+
+template <typename Key>
+bool BasicStorageEngine<Key>::del(const Key &key)
 {
     cache_.remove(key); // 从缓存中删除
     return file_store_->del(key);
 }
 
-size_t StorageEngine::getFileStoreReadCount() const
+template <typename Key>
+size_t BasicStorageEngine<Key>::getFileStoreReadCount() const
 {
     return file_store_->getReadCount();
 }
 
-void StorageEngine::garbageCollect()
+template <typename Key>
+size_t BasicStorageEngine<Key>::getCacheMemoryUsage() const
+{
+    return cache_.memoryUsage();
+}
+
+template <typename Key>
+std::vector<CacheSegmentStats> BasicStorageEngine<Key>::getCacheSegmentStats() const
+{
+    return cache_.getSegmentStats();
+}
+
+template <typename Key>
+void BasicStorageEngine<Key>::garbageCollect()
 {
     file_store_->garbageCollect();
-}
\ No newline at end of file
+}
+
+template <typename Key>
+bool BasicStorageEngine<Key>::sync()
+{
+    return file_store_->sync();
+}
+
+template class BasicStorageEngine<int>;
+template class BasicStorageEngine<std::string>;
@@ -0,0 +1,121 @@
+#include "epoch.h"
+#include <algorithm>
+
+namespace
+{
+    // 每个线程一条记录，按缓存行对齐，读者登记时只写自己的记录
+    struct alignas(64) Record
+    {
+        std::atomic<uint64_t> epoch{0}; // 进入时的全局纪元，0 表示不在临界区
+        std::atomic<bool> in_use{false};
+        unsigned depth = 0; // 嵌套层数，只由持有该记录的线程访问
+        Record *next = nullptr;
+    };
+
+    std::atomic<uint64_t> global_epoch{1};
+    std::atomic<Record *> records{nullptr}; // 只增不减的记录链表，线程退出后记录留给新线程复用
+
+    Record *acquireRecord()
+    {
+        for (Record *r = records.load(std::memory_order_acquire); r; r = r->next)
+        {
+            bool expected = false;
+            if (!r->in_use.load(std::memory_order_relaxed) && r->in_use.compare_exchange_strong(expected, true))
+            {
+                return r;
+            }
+        }
+        Record *r = new Record;
+        r->in_use.store(true, std::memory_order_relaxed);
+        Record *head = records.load(std::memory_order_relaxed);
+        do
+        {
+            r->next = head;
+        } while (!records.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+        return r;
+    }
+
+    struct ThreadRecord
+    {
+        Record *record = acquireRecord();
+        ~ThreadRecord()
+        {
+            record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    Record &threadRecord()
+    {
+        thread_local ThreadRecord thread_record;
+        return *thread_record.record;
+    }
+
+    // 仍在临界区中的读者进入时的最小纪元，没有读者时为 UINT64_MAX
+    uint64_t oldestActiveEpoch()
+    {
+        uint64_t oldest = UINT64_MAX;
+        for (Record *r = records.load(std::memory_order_acquire); r; r = r->next)
+        {
+            uint64_t epoch = r->epoch.load(std::memory_order_acquire);
+            if (epoch != 0)
+            {
+                oldest = std::min(oldest, epoch);
+            }
+        }
+        return oldest;
+    }
+}
+
+// 登记后的全序栅栏与写者摘除对象后的栅栏配对：读者要么看到摘除后的结构，
+// 要么写者回收时看到读者登记的纪元（不大于对象摘除后读到的纪元），对象因此不会被提前释放
+EpochGuard::EpochGuard()
+{
+    Record &record = threadRecord();
+    if (record.depth++ == 0)
+    {
+        record.epoch.store(global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+EpochGuard::~EpochGuard()
+{
+    Record &record = threadRecord();
+    if (--record.depth == 0)
+    {
+        record.epoch.store(0, std::memory_order_release);
+    }
+}
+
+RetireList::~RetireList()
+{
+    for (const Retired &item : items_)
+    {
+        item.deleter(item.ptr);
+    }
+}
+
+void RetireList::push(void *ptr, void (*deleter)(void *))
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    items_.push_back(Retired{ptr, deleter, global_epoch.load(std::memory_order_relaxed)});
+    if (items_.size() >= reclaim_at_)
+    {
+        reclaim();
+    }
+}
+
+// 先推进全局纪元，之后进入的读者都登记更大的纪元；摘除时的纪元小于所有仍在临界区的读者的对象即可释放
+void RetireList::reclaim()
+{
+    global_epoch.fetch_add(1, std::memory_order_seq_cst);
+    uint64_t oldest = oldestActiveEpoch();
+    auto kept = std::partition(items_.begin(), items_.end(), [oldest](const Retired &item)
+                               { return item.epoch >= oldest; });
+    for (auto it = kept; it != items_.end(); ++it)
+    {
+        it->deleter(it->ptr);
+    }
+    items_.erase(kept, items_.end());
+    reclaim_at_ = items_.size() + RECLAIM_BATCH;
+}
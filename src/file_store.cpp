@@ -3,68 +3,177 @@
 #include <cstring>
 #include <chrono>
 #include <thread>
+#include <cerrno>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 // 索引文件存储路径
 #define INDEX_FILE_SUFFIX ".idx"
 
-FileStore::FileStore(const std::string &file_path, bool clean_start)
-    : file_path_(file_path), file_size_(0), stop_gc_thread_(false), read_count_(0)
+// 提示文件路径：<段文件>.hint
+#define HINT_FILE_SUFFIX ".hint"
+
+// blob 文件路径：<段文件>.blob
+#define BLOB_FILE_SUFFIX ".blob"
+
+// 尚未发布的压缩输出段：<段文件>.tmp
+#define TEMP_FILE_SUFFIX ".tmp"
+
+// 顺序扫描段时每次读取的块大小，也是压缩时输出缓冲区的刷写阈值
+static const size_t SCAN_CHUNK_SIZE = 1024 * 1024;
+
+// 压缩时每次持有索引共享锁检查的记录数
+static const size_t LIVE_CHECK_BATCH = 256;
+
+// 范围扫描合并读取时允许跨过的最大空洞（中间被覆盖或不在区间内的记录），多读这些字节比多一次 pread 划算
+static const size_t SCAN_MAX_GAP = 64 * 1024;
+
+namespace
+{
+    struct SegmentFile
+    {
+        std::string path;
+        bool blob;
+    };
+
+    // 列出 file_path 对应的所有段文件：<file_path>.<8 位十进制 id>，blob 文件再加 .blob 后缀；
+    // suffix 非空时列出带该后缀的同名文件（如尚未发布的压缩输出段）
+    std::map<uint32_t, SegmentFile> listSegmentFiles(const std::string &file_path, const std::string &suffix = "")
+    {
+        namespace fs = std::filesystem;
+        std::map<uint32_t, SegmentFile> files;
+        fs::path base(file_path);
+        fs::path dir = base.parent_path().empty() ? fs::path(".") : base.parent_path();
+        std::string prefix = base.filename().string() + ".";
+
+        std::error_code ec;
+        for (const auto &entry : fs::directory_iterator(dir, ec))
+        {
+            std::string name = entry.path().filename().string();
+            if (name.size() < suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            {
+                continue;
+            }
+            name.resize(name.size() - suffix.size());
+            const std::string blob_suffix = BLOB_FILE_SUFFIX;
+            bool blob = name.size() == prefix.size() + 8 + blob_suffix.size() &&
+                        name.compare(name.size() - blob_suffix.size(), blob_suffix.size(), blob_suffix) == 0;
+            if ((!blob && name.size() != prefix.size() + 8) || name.compare(0, prefix.size(), prefix) != 0)
+            {
+                continue;
+            }
+            std::string digits = name.substr(prefix.size(), 8);
+            if (!std::all_of(digits.begin(), digits.end(), ::isdigit))
+            {
+                continue;
+            }
+            files[static_cast<uint32_t>(std::stoul(digits))] = SegmentFile{entry.path().string(), blob};
+        }
+        return files;
+    }
+}
+
+Segment::~Segment()
+{
+    if (map)
+    {
+        ::munmap(map, map_size);
+    }
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+}
+
+template <typename Key>
+BasicFileStore<Key>::BasicFileStore(const std::string &file_path, bool clean_start, const FileStoreOptions &options)
+    : file_path_(file_path), options_(options), next_segment_id_(1), next_seq_(1), published_seq_(1), bytes_since_checkpoint_(0),
+      stop_gc_thread_(false), read_count_(0), commit_batch_count_(0)
 {
     if (clean_start)
     {
-        if (std::ifstream(file_path_))
+        for (const auto &file : listSegmentFiles(file_path_))
         {
-            std::remove(file_path_.c_str());
+            std::remove(file.second.path.c_str());
+            std::remove((file.second.path + HINT_FILE_SUFFIX).c_str());
         }
-        std::string index_file_path = file_path_ + INDEX_FILE_SUFFIX;
-        if (std::ifstream(index_file_path))
+        for (const auto &file : listSegmentFiles(file_path_, TEMP_FILE_SUFFIX))
         {
-            std::remove(index_file_path.c_str());
+            std::remove(file.second.path.c_str());
         }
+        std::string index_file_path = file_path_ + INDEX_FILE_SUFFIX;
+        std::remove(index_file_path.c_str());
+        std::remove((index_file_path + ".tmp").c_str());
     }
 
-    // 若数据文件不存在则创建空文件
-    if (!std::ifstream(file_path_))
+    if (options_.inline_value_max_size > 0)
     {
-        std::ofstream create_file(file_path_, std::ios::binary);
-        create_file.close();
+        index_.enableInlineValues();
+        inline_threshold_ = options_.inline_value_max_size;
     }
 
+    // 打开所有段并加载索引
+    loadIndex();
+
+    if (options_.use_io_uring)
     {
-        std::lock_guard<std::mutex> lock(file_mtx_);
-        file_.open(file_path_, std::ios::in | std::ios::out | std::ios::binary);
-        if (!file_)
+        io_ring_ = std::make_unique<IoRing>(options_.io_uring_entries);
+        if (!io_ring_->available())
         {
-            std::cerr << "Failed to open data file: " << file_path_ << std::endl;
+            io_ring_.reset(); // 内核不支持，异步接口回退到同步 I/O
         }
     }
 
-    // 加载索引
-    loadIndex();
-
     // 启动GC线程
     startGCThread();
+    startSyncThread();
 }
 
-FileStore::~FileStore()
+template <typename Key>
+BasicFileStore<Key>::~BasicFileStore()
 {
-    stop_gc_thread_ = true; // 停止垃圾回收线程
+    // 等待所有异步请求的回调执行完毕
+    {
+        std::unique_lock<std::mutex> lock(async_mtx_);
+        async_cv_.wait(lock, [this]
+                       { return async_pending_ == 0; });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(gc_wait_mtx_);
+        stop_gc_thread_ = true; // 停止垃圾回收线程
+    }
+    gc_cv_.notify_all();
 
     if (gc_thread_.joinable())
     {
         gc_thread_.join(); // 等待线程退出
     }
 
-    if (file_.is_open())
     {
-        file_.close();
+        std::lock_guard<std::mutex> lock(sync_wait_mtx_);
+        stop_sync_thread_ = true;
+    }
+    sync_cv_.notify_all();
+    if (sync_thread_.joinable())
+    {
+        sync_thread_.join();
+    }
+    if (options_.sync_mode != SyncMode::None)
+    {
+        sync();
     }
 
     saveIndex();
 }
 
 // 启动垃圾回收后台线程
-void FileStore::startGCThread()
+template <typename Key>
+void BasicFileStore<Key>::startGCThread()
 {
     if (gc_thread_.joinable())
     {
@@ -73,254 +182,2319 @@ void FileStore::startGCThread()
 
     gc_thread_ = std::thread([this]()
                              {
+        // 除按间隔检查是否需要压缩外，还负责保存写入路径请求的检查点
+        std::unique_lock<std::mutex> lock(gc_wait_mtx_);
+        auto next_check = std::chrono::steady_clock::now() + options_.gc_check_interval;
         while (!stop_gc_thread_) {
-            std::this_thread::sleep_for(std::chrono::hours(2));
-            garbageCollect();
+            gc_cv_.wait_until(lock, next_check, [this]
+                              { return stop_gc_thread_.load() || checkpoint_requested_.load(); });
+            if (stop_gc_thread_) {
+                break;
+            }
+            lock.unlock();
+            if (checkpoint_requested_.exchange(false)) {
+                saveIndex();
+            }
+            if (std::chrono::steady_clock::now() >= next_check) {
+                if (shouldCollect()) {
+                    garbageCollect();
+                }
+                next_check = std::chrono::steady_clock::now() + options_.gc_check_interval;
+            }
+            lock.lock();
         } });
 }
 
-size_t FileStore::getReadCount() const
+// Interval 模式：按间隔同步当前段，累计未同步字节达到阈值时由写入路径提前唤醒
+template <typename Key>
+void BasicFileStore<Key>::startSyncThread()
 {
-    return read_count_;
+    if (options_.sync_mode != SyncMode::Interval || sync_thread_.joinable())
+    {
+        return;
+    }
+
+    sync_thread_ = std::thread([this]()
+                               {
+        std::unique_lock<std::mutex> lock(sync_wait_mtx_);
+        while (!stop_sync_thread_) {
+            sync_cv_.wait_for(lock, options_.sync_interval, [this] {
+                return stop_sync_thread_ || (options_.sync_interval_bytes > 0 && unsynced_bytes_ >= options_.sync_interval_bytes);
+            });
+            if (stop_sync_thread_) {
+                break;
+            }
+            lock.unlock();
+            size_t pending = unsynced_bytes_;
+            std::shared_ptr<Segment> active;
+            std::shared_ptr<Segment> blob_active;
+            {
+                std::shared_lock<std::shared_mutex> segments_lock(segments_mtx_);
+                active = active_;
+                blob_active = blob_active_;
+            }
+            if (pending > 0 && active && syncSegment(*active) && (!blob_active || syncSegment(*blob_active))) {
+                unsynced_bytes_ -= pending;
+            }
+            lock.lock();
+        } });
 }
 
-// 同步方法 put
-bool FileStore::put(int key, const std::string &value)
+template <typename Key>
+bool BasicFileStore<Key>::sync()
 {
-    // 直接使用独占锁
-    std::unique_lock<std::shared_mutex> index_lock(index_mtx_);
-
-    // 写入文件数据
-    size_t offset;
+    // 封存段在 None 模式下滚动时未同步，逐段同步；已干净的段 fdatasync 几乎没有开销
+    size_t pending = unsynced_bytes_;
+    std::vector<std::shared_ptr<Segment>> segments;
     {
-        std::lock_guard<std::mutex> file_lock(file_mtx_);
-        offset = file_size_;
-        file_.seekp(file_size_, std::ios::beg);
-        file_.write(value.c_str(), value.size());
-        if (!file_)
+        std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+        for (const auto &entry : segments_)
         {
-            std::cerr << "Failed to write to file." << std::endl;
-            return false;
+            segments.push_back(entry.second);
         }
-        file_.flush();
-        file_size_ += value.size();
     }
+    bool ok = true;
+    for (const auto &seg : segments)
+    {
+        ok = syncSegment(*seg) && ok;
+    }
+    if (ok)
+    {
+        unsynced_bytes_ -= pending;
+    }
+    return ok;
+}
 
-    // 更新索引
-    index_[key] = ObjectMeta{key, offset, value.size(), false};
+template <typename Key>
+size_t BasicFileStore<Key>::getSyncCount() const
+{
+    return sync_count_;
+}
 
+template <typename Key>
+bool BasicFileStore<Key>::syncSegment(const Segment &segment)
+{
+    int ret;
+    do
+    {
+        ret = ::fdatasync(segment.fd);
+    } while (ret != 0 && errno == EINTR);
+    sync_count_++;
+    if (ret != 0)
+    {
+        std::cerr << "Failed to sync segment " << segment.id << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
     return true;
 }
 
-// 同步方法 get
-std::string FileStore::get(int key)
+template <typename Key>
+void BasicFileStore<Key>::syncDirectory()
 {
-    // 查找索引
-    std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
-    auto it = index_.find(key);
-    if (it == index_.end() || it->second.deleted)
+    std::filesystem::path dir = std::filesystem::path(file_path_).parent_path();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
     {
-        return ""; // Key 未找到或已被删除
+        return;
     }
+    if (::fsync(fd) != 0)
+    {
+        std::cerr << "Failed to sync directory: " << dir << std::endl;
+    }
+    ::close(fd);
+}
 
-    const ObjectMeta &meta = it->second;
-
-    // 从文件读取数据
-    std::string value;
-    value.resize(meta.size);
+template <typename Key>
+bool BasicFileStore<Key>::shouldCollect()
+{
+    size_t data_bytes = 0;
+    size_t dead_bytes = 0;
+    size_t live_bytes = 0;
     {
-        std::lock_guard<std::mutex> file_lock(file_mtx_);
-        file_.seekg(meta.offset, std::ios::beg);
-        file_.read(&value[0], meta.size);
-        if (!file_)
+        std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+        for (const auto &entry : segments_)
         {
-            std::cerr << "Failed to read from file." << std::endl;
-            return "";
+            data_bytes += entry.second->size - DATA_FILE_HEADER_SIZE;
+            dead_bytes += entry.second->dead_bytes;
+            live_bytes += entry.second->live_bytes;
         }
-        read_count_++;
     }
+    double dead_ratio = data_bytes > 0 ? static_cast<double>(dead_bytes) / data_bytes : 0;
+    double space_amplification = live_bytes > 0 ? static_cast<double>(data_bytes) / live_bytes : 1;
 
-    return value;
+    std::lock_guard<std::mutex> lock(gc_mtx_);
+    gc_stats_.dead_ratio = dead_ratio;
+    gc_stats_.space_amplification = space_amplification;
+    bool triggered = dead_bytes >= options_.gc_min_dead_bytes &&
+                     (dead_ratio >= options_.gc_trigger_dead_ratio ||
+                      space_amplification >= options_.gc_trigger_space_amplification);
+    if (!triggered)
+    {
+        gc_stats_.skipped++;
+    }
+    return triggered;
 }
 
-// 同步方法 del
-bool FileStore::del(int key)
+template <typename Key>
+GCStats BasicFileStore<Key>::getGCStats()
 {
-    // 从索引中查找
-    std::unique_lock<std::shared_mutex> index_lock(index_mtx_);
-    auto it = index_.find(key);
-    if (it == index_.end() || it->second.deleted)
+    std::lock_guard<std::mutex> lock(gc_mtx_);
+    return gc_stats_;
+}
+
+template <typename Key>
+InlineValueStats BasicFileStore<Key>::getInlineValueStats()
+{
+    std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+    return InlineValueStats{index_.inlineBytes(), inline_threshold_, inline_hits_};
+}
+
+template <typename Key>
+std::vector<BasicScanEntry<Key>> BasicFileStore<Key>::scan(const Key &start, const Key &end, size_t limit)
+{
+    // 在索引共享锁内确定区间内的 key 及其位置，并取得段的引用
+    std::vector<Key> keys;
+    std::vector<ReadItem> items;
+    std::vector<std::string> values;
+    std::vector<bool> ok;
     {
-        return false; // Key 未找到或已被删除
+        std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+        if (options_.ordered_index)
+        {
+            ordered_keys_.forRange(start, end, [&](const Key &key)
+                                   {
+                keys.push_back(key);
+                return keys.size() < limit; });
+        }
+        else
+        {
+            // 没有有序索引时遍历整个哈希索引
+            index_.forEach([&](const ObjectMeta &meta)
+                           {
+                if (!meta.deleted && meta.key >= start && meta.key < end) {
+                    keys.push_back(meta.key);
+                } });
+            std::sort(keys.begin(), keys.end());
+            if (keys.size() > limit)
+            {
+                keys.resize(limit);
+            }
+        }
+
+        // 内联的 value 直接取得，其余的记录位置稍后读取
+        values.resize(keys.size());
+        ok.resize(keys.size(), false);
+        items.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            ok[i] = lookupLocked(keys[i], i, items, values);
+        }
     }
 
-    // 标记为已删除
-    it->second.deleted = true;
+    readChunks(items, values);
 
-    return true;
+    // 去掉读取失败的项，保持 key 的升序
+    for (const ReadItem &item : items)
+    {
+        ok[item.slot] = item.ok;
+    }
+    std::vector<ScanEntry> results;
+    results.reserve(items.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        if (ok[i])
+        {
+            results.push_back(ScanEntry{std::move(keys[i]), std::move(values[i])});
+        }
+    }
+    return results;
+}
+
+// 按段和偏移排序后划分读取块：同一段中相距不超过 SCAN_MAX_GAP 的记录合并为一次读，
+// 每块不超过 SCAN_CHUNK_SIZE（单条记录更大时单独成块）
+template <typename Key>
+std::vector<typename BasicFileStore<Key>::ReadChunk> BasicFileStore<Key>::planReads(std::vector<ReadItem> &items)
+{
+    std::sort(items.begin(), items.end(), [](const ReadItem &a, const ReadItem &b)
+              { return a.meta.segment_id != b.meta.segment_id ? a.meta.segment_id < b.meta.segment_id : a.meta.offset < b.meta.offset; });
+    std::vector<ReadChunk> chunks;
+    for (size_t first = 0; first < items.size();)
+    {
+        const std::shared_ptr<Segment> &seg = items[first].seg;
+        size_t chunk_start = items[first].meta.offset;
+        size_t chunk_end = chunk_start + recordSize(items[first].meta.size, Traits::size(items[first].meta.key));
+        size_t last = first + 1;
+        for (; last < items.size() && items[last].seg == seg; ++last)
+        {
+            size_t record_end = items[last].meta.offset + recordSize(items[last].meta.size, Traits::size(items[last].meta.key));
+            if (items[last].meta.offset > chunk_end + SCAN_MAX_GAP || record_end - chunk_start > SCAN_CHUNK_SIZE)
+            {
+                break;
+            }
+            chunk_end = std::max(chunk_end, record_end);
+        }
+        chunks.push_back(ReadChunk{first, last, chunk_start, chunk_end});
+        first = last;
+    }
+    return chunks;
 }
 
-// 定期清理无效数据
-void FileStore::garbageCollect()
+// 调用方持有索引锁。value 内联在索引中时直接写入 values[slot] 并返回 true，
+// 否则把记录位置加入 items 等待读取
+template <typename Key>
+bool BasicFileStore<Key>::lookupLocked(const Key &key, size_t slot, std::vector<ReadItem> &items, std::vector<std::string> &values)
 {
-    // std::cerr << "Start garbageCollect...." << std::endl;
-    // printFileContext();
+    ObjectMeta meta;
+    if (!index_.find(key, meta) || meta.deleted)
+    {
+        return false;
+    }
+    if (meta.value)
+    {
+        values[slot].assign(meta.value, meta.size);
+        inline_hits_++;
+        return true;
+    }
+    items.push_back(ReadItem{meta, findSegment(meta.segment_id), slot});
+    return false;
+}
 
-    // 获取独占锁，防止其他操作
-    std::unique_lock<std::shared_mutex>
-        lock(index_mtx_);
+template <typename Key>
+void BasicFileStore<Key>::lookupForRead(std::span<const Key> keys, std::vector<ReadItem> &items, std::vector<std::string> &values)
+{
+    items.reserve(keys.size());
+    std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        lookupLocked(keys[i], i, items, values);
+    }
+}
 
-    std::vector<ObjectMeta> live_objects;
+// base 指向块在段内 start 处的数据
+template <typename Key>
+void BasicFileStore<Key>::copyValues(const ReadChunk &chunk, const char *base, std::vector<ReadItem> &items, std::vector<std::string> &values)
+{
+    read_count_++;
+    for (size_t i = chunk.first; i < chunk.last; ++i)
+    {
+        const ObjectMeta &meta = items[i].meta;
+        values[items[i].slot].assign(base + (meta.offset - chunk.start) + recordValueOffset(Traits::size(meta.key)), meta.size);
+        items[i].ok = true;
+    }
+}
 
-    // 遍历索引表，保留没有被删除的对象
-    for (auto &entry : index_)
+template <typename Key>
+void BasicFileStore<Key>::readChunks(std::vector<ReadItem> &items, std::vector<std::string> &values)
+{
+    std::string buffer;
+    for (const ReadChunk &chunk : planReads(items))
     {
-        const ObjectMeta &meta = entry.second;
-        if (!meta.deleted)
+        // 映射覆盖整块时直接拷贝，否则一次 pread 读入整块
+        const std::shared_ptr<Segment> &seg = items[chunk.first].seg;
+        if (seg && seg->map && chunk.end <= seg->map_size)
+        {
+            copyValues(chunk, seg->map + chunk.start, items, values);
+            continue;
+        }
+        buffer.resize(chunk.end - chunk.start);
+        if (seg && preadFull(seg->fd, &buffer[0], buffer.size(), chunk.start))
+        {
+            copyValues(chunk, buffer.data(), items, values);
+        }
+        else
         {
-            live_objects.push_back(meta);
+            std::cerr << "Failed to read from file." << std::endl;
         }
     }
-
-    // 压缩文件，只保留有效对象
-    compactFile(live_objects);
-
-    // std::cerr << "After garbageCollect...." << std::endl;
-    // printFileContext();
 }
 
-// 压缩文件，移除已删除对象的存储
-void FileStore::compactFile(const std::vector<ObjectMeta> &live_objects)
+template <typename Key>
+std::vector<std::string> BasicFileStore<Key>::multiGet(std::span<const Key> keys)
 {
-    std::lock_guard<std::mutex> lock(file_mtx_);
+    std::vector<ReadItem> items;
+    std::vector<std::string> values(keys.size());
+    lookupForRead(keys, items, values);
+    readChunks(items, values);
+    return values;
+}
 
-    std::fstream temp_file(file_path_ + ".tmp", std::ios::out | std::ios::binary);
-    if (!temp_file)
+template <typename Key>
+void BasicFileStore<Key>::asyncMultiGet(std::span<const Key> keys, std::function<void(std::vector<std::string>)> callback)
+{
+    if (!io_ring_)
     {
-        std::cerr << "Failed to create temporary file for compacting." << std::endl;
+        callback(multiGet(keys));
         return;
     }
 
-    size_t new_offset = 0;
-    std::unordered_map<int, ObjectMeta> new_index;
-
-    // 将有效数据写入新的文件
-    for (const auto &meta : live_objects)
+    // 各块的读取完成顺序不定，最后一个完成者回调；remaining 多计的 1 由提交线程在提交完所有块后释放
+    struct State
     {
-        std::string data;
-        data.resize(meta.size);
+        std::vector<ReadItem> items;
+        std::vector<std::string> values;
+        std::atomic<size_t> remaining{1};
+        std::function<void(std::vector<std::string>)> callback;
+    };
+    auto state = std::make_shared<State>();
+    state->values.resize(keys.size());
+    state->callback = std::move(callback);
+    lookupForRead(keys, state->items, state->values);
+    std::vector<ReadChunk> chunks = planReads(state->items);
+    state->remaining += chunks.size();
+    auto release = [](State &st)
+    {
+        if (--st.remaining == 0)
+        {
+            st.callback(std::move(st.values));
+        }
+    };
 
-        // 读取旧文件中的有效数据
-        file_.seekg(meta.offset, std::ios::beg);
-        file_.read(&data[0], meta.size);
+    for (const ReadChunk &chunk : chunks)
+    {
+        std::shared_ptr<Segment> seg = state->items[chunk.first].seg;
+        if (seg && seg->map && chunk.end <= seg->map_size)
+        {
+            copyValues(chunk, seg->map + chunk.start, state->items, state->values);
+            release(*state);
+            continue;
+        }
+        auto buffer = std::make_shared<std::string>(chunk.end - chunk.start, '\0');
+        if (seg)
+        {
+            // 回调持有段的引用，读取完成前段文件不会被关闭
+            beginAsyncOp();
+            bool submitted = io_ring_->read(seg->fd, &(*buffer)[0], buffer->size(), chunk.start,
+                                            [this, state, seg, buffer, chunk, release](int res)
+                                            {
+                                                size_t done = res > 0 ? static_cast<size_t>(res) : 0;
+                                                if (res >= 0 && preadFull(seg->fd, &(*buffer)[done], buffer->size() - done, chunk.start + done))
+                                                {
+                                                    copyValues(chunk, buffer->data(), state->items, state->values);
+                                                }
+                                                else
+                                                {
+                                                    std::cerr << "Failed to read from file." << std::endl;
+                                                }
+                                                release(*state);
+                                                endAsyncOp();
+                                            });
+            if (submitted)
+            {
+                continue;
+            }
+            endAsyncOp();
+        }
+        if (seg && preadFull(seg->fd, &(*buffer)[0], buffer->size(), chunk.start))
+        {
+            copyValues(chunk, buffer->data(), state->items, state->values);
+        }
+        else
+        {
+            std::cerr << "Failed to read from file." << std::endl;
+        }
+        release(*state);
+    }
+    release(*state);
+}
 
-        // 将数据写入新文件
-        temp_file.write(data.c_str(), data.size());
+template <typename Key>
+size_t BasicFileStore<Key>::getReadCount() const
+{
+    return read_count_;
+}
 
-        // 更新索引
-        ObjectMeta new_meta = meta;
-        new_meta.offset = new_offset; // 更新偏移量
+template <typename Key>
+size_t BasicFileStore<Key>::getCommitBatchCount() const
+{
+    return commit_batch_count_;
+}
 
-        new_index[meta.key] = new_meta;
-        new_offset += data.size();
+template <typename Key>
+std::vector<SegmentStats> BasicFileStore<Key>::getSegmentStats()
+{
+    std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+    std::vector<SegmentStats> stats;
+    stats.reserve(segments_.size());
+    for (const auto &entry : segments_)
+    {
+        const Segment &seg = *entry.second;
+        stats.push_back(SegmentStats{seg.id, seg.size, seg.live_bytes, seg.dead_bytes, seg.sealed, seg.blob});
     }
+    return stats;
+}
 
-    // 关闭临时文件
-    temp_file.close();
+// 同步方法 put
+template <typename Key>
+bool BasicFileStore<Key>::put(const Key &key, const std::string &value)
+{
+    if (!Traits::valid(key))
+    {
+        std::cerr << "Key exceeds the maximum key size." << std::endl;
+        return false;
+    }
+    WriteRequest request{key, &value};
+    return submitWrites(&request, 1);
+}
 
-    // 替换原文件
-    file_.close();
-    std::rename((file_path_ + ".tmp").c_str(), file_path_.c_str());
+template <typename Key>
+bool BasicFileStore<Key>::multiPut(std::span<const std::pair<Key, std::string>> items)
+{
+    std::vector<WriteRequest> requests;
+    requests.reserve(items.size());
+    for (const auto &item : items)
+    {
+        if (!Traits::valid(item.first))
+        {
+            std::cerr << "Key exceeds the maximum key size." << std::endl;
+            return false;
+        }
+        requests.push_back(WriteRequest{item.first, &item.second});
+    }
+    return requests.empty() || submitWrites(requests.data(), requests.size());
+}
 
-    // 重新打开file_：
-    file_.open(file_path_, std::ios::in | std::ios::out | std::ios::binary);
-    if (!file_.is_open())
+template <typename Key>
+void BasicFileStore<Key>::asyncMultiPut(std::span<const std::pair<Key, std::string>> items, std::function<void(bool)> callback)
+{
+    bool valid = std::all_of(items.begin(), items.end(), [](const auto &item)
+                             { return Traits::valid(item.first); });
+    if (!io_ring_ || !valid || items.empty())
     {
-        std::cerr << "Failed to reopen data file after compaction." << std::endl;
+        callback(multiPut(items));
+        return;
     }
 
-    // 更新索引
-    index_ = std::move(new_index);
-    file_size_ = new_offset; // 更新文件大小
+    // 同一批次的请求在完成线程上依次回调，最后一个回调时汇总结果
+    struct State
+    {
+        std::atomic<size_t> remaining;
+        std::atomic<bool> success{true};
+        std::function<void(bool)> callback;
+    };
+    auto state = std::make_shared<State>();
+    state->remaining = items.size();
+    state->callback = std::move(callback);
+    std::vector<WriteRequest *> requests;
+    requests.reserve(items.size());
+    for (const auto &item : items)
+    {
+        auto *request = new WriteRequest{item.first, nullptr};
+        request->owned_value = item.second;
+        request->value = &request->owned_value;
+        request->callback = [state](bool success)
+        {
+            if (!success)
+            {
+                state->success = false;
+            }
+            if (--state->remaining == 0)
+            {
+                state->callback(state->success);
+            }
+        };
+        requests.push_back(request);
+        beginAsyncOp();
+    }
+    submitWritesAsync(requests);
 }
 
-void FileStore::loadIndex()
+template <typename Key>
+bool BasicFileStore<Key>::write(const BasicWriteBatch<Key> &batch)
 {
-    std::string index_file_path = file_path_ + INDEX_FILE_SUFFIX;
-    std::ifstream index_file(index_file_path, std::ios::in | std::ios::binary);
+    for (const auto &op : batch.operations())
+    {
+        if (!Traits::valid(op.key))
+        {
+            std::cerr << "Key exceeds the maximum key size." << std::endl;
+            return false;
+        }
+    }
+    if (batch.empty())
+    {
+        return true;
+    }
+    WriteRequest request{Key{}, nullptr};
+    request.batch = &batch;
+    return submitWrites(&request, 1);
+}
 
-    if (!index_file)
+template <typename Key>
+void BasicFileStore<Key>::asyncWrite(const BasicWriteBatch<Key> &batch, std::function<void(bool)> callback)
+{
+    bool valid = std::all_of(batch.operations().begin(), batch.operations().end(), [](const auto &op)
+                             { return Traits::valid(op.key); });
+    if (!io_ring_ || !valid || batch.empty())
     {
-        std::cerr << "No existing index file found. Starting fresh." << std::endl;
-        return; // 如果没有索引文件，启动时不会加载任何元数据
+        callback(write(batch));
+        return;
     }
 
-    // 从索引文件中读取所有元数据
-    size_t index_size;
-    index_file.read(reinterpret_cast<char *>(&index_size), sizeof(index_size));
+    auto *request = new WriteRequest{Key{}, nullptr};
+    request->owned_batch = batch;
+    request->batch = &request->owned_batch;
+    request->callback = std::move(callback);
+    beginAsyncOp();
+    submitWritesAsync({request});
+}
 
-    for (size_t i = 0; i < index_size; ++i)
+// 将请求加入提交队列；已有 leader 时等待其完成，否则自己成为 leader。
+// 请求在同一次加锁中入队，leader 一次取走整个队列，因此它们总在同一批次中写入并一起置位 done
+template <typename Key>
+bool BasicFileStore<Key>::submitWrites(WriteRequest *requests, size_t count)
+{
+    std::unique_lock<std::mutex> lock(commit_mtx_);
+    for (size_t i = 0; i < count; ++i)
     {
-        ObjectMeta meta;
-        index_file.read(reinterpret_cast<char *>(&meta), sizeof(ObjectMeta));
-        index_[meta.key] = meta;
+        commit_queue_.push_back(&requests[i]);
     }
 
-    // 计算文件大小：遍历索引，找出最大的偏移量 + 对应的大小
-    file_size_ = 0;
-    for (const auto &pair : index_)
+    // 已有 leader 时等待它替我们完成写入；leader 交还令牌时请求仍在队列中则由本线程接任
+    const WriteRequest &last = requests[count - 1];
+    commit_cv_.wait(lock, [this, &last]
+                    { return last.done || !commit_leader_active_; });
+    if (!last.done)
     {
-        const ObjectMeta &meta = pair.second;
-        size_t end_position = meta.offset + meta.size;
-        if (end_position > file_size_)
+        commit_leader_active_ = true;
+        lock.unlock();
+        driveCommits(false);
+    }
+    return std::all_of(requests, requests + count, [](const WriteRequest &request)
+                       { return request.success; });
+}
+
+// 异步请求入队后立即返回；没有 leader 时由调用线程编码并提交第一批异步写
+template <typename Key>
+void BasicFileStore<Key>::submitWritesAsync(const std::vector<WriteRequest *> &requests)
+{
+    {
+        std::lock_guard<std::mutex> lock(commit_mtx_);
+        commit_queue_.insert(commit_queue_.end(), requests.begin(), requests.end());
+        if (commit_leader_active_)
         {
-            file_size_ = end_position;
+            return; // 当前 leader 处理完手头的批次后会接着处理
         }
+        commit_leader_active_ = true;
     }
+    driveCommits(true);
+}
 
-    index_file.close();
+template <typename Key>
+void BasicFileStore<Key>::acquireCommitToken()
+{
+    std::unique_lock<std::mutex> lock(commit_mtx_);
+    commit_cv_.wait(lock, [this]
+                    { return !commit_leader_active_; });
+    commit_leader_active_ = true;
 }
 
-void FileStore::saveIndex()
+template <typename Key>
+void BasicFileStore<Key>::driveCommits(bool async)
 {
-    std::string index_file_path = file_path_ + INDEX_FILE_SUFFIX;
-    std::ofstream index_file(index_file_path, std::ios::out | std::ios::binary);
+    std::unique_lock<std::mutex> lock(commit_mtx_);
+    while (!commit_queue_.empty())
+    {
+        auto commit = std::make_shared<PendingCommit>();
+        commit->requests.assign(commit_queue_.begin(), commit_queue_.end());
+        commit_queue_.clear();
+        lock.unlock();
+
+        bool ok = prepareCommit(*commit);
+        bool per_write = options_.sync_mode == SyncMode::PerWrite;
+        if (ok && async && io_ring_)
+        {
+            // blob 文件与主日志的写入（逐批同步模式下各跟一个 fdatasync）作为一条链一次提交，
+            // 按顺序执行，前一步失败时后续步骤被取消；完成线程只处理结果，不在其上做阻塞的 I/O
+            std::vector<IoRing::LinkedWrite> writes;
+            if (!commit->blob_buffer.empty())
+            {
+                writes.push_back({commit->blob_segment->fd, commit->blob_buffer.data(), commit->blob_buffer.size(), commit->blob_offset});
+                if (per_write)
+                {
+                    writes.push_back({commit->blob_segment->fd, nullptr, 0, 0});
+                }
+            }
+            if (!commit->buffer.empty())
+            {
+                writes.push_back({commit->segment->fd, commit->buffer.data(), commit->buffer.size(), commit->offset});
+                if (per_write)
+                {
+                    writes.push_back({commit->segment->fd, nullptr, 0, 0});
+                }
+            }
+
+            // 完成回调还会继续处理后续批次，整个过程计为一个在途的异步操作
+            size_t syncs = per_write ? writes.size() / 2 : 0;
+            beginAsyncOp();
+            if (!writes.empty() &&
+                io_ring_->writeLinked(writes, [this, commit, syncs](int res)
+                                      {
+                                          sync_count_ += res == 0 ? syncs : 0;
+                                          completeAsyncCommit(commit, res == 0);
+                                      }))
+            {
+                return; // 令牌随批次交给完成线程
+            }
+            endAsyncOp();
+        }
+
+        // 同步写入，或异步提交失败时回退：大 value 先写入 blob 文件，主日志部分随后写入；
+        // 逐批同步模式下整批共享一次 fdatasync
+        if (ok && commit->blob_segment)
+        {
+            ok = pwriteFull(commit->blob_segment->fd, commit->blob_buffer.data(), commit->blob_buffer.size(), commit->blob_offset) &&
+                 (!per_write || syncSegment(*commit->blob_segment));
+        }
+        ok = ok && (commit->buffer.empty() ||
+                    (pwriteFull(commit->segment->fd, commit->buffer.data(), commit->buffer.size(), commit->offset) &&
+                     (!per_write || syncSegment(*commit->segment))));
+        finishCommit(*commit, ok);
+        lock.lock();
+    }
+    commit_leader_active_ = false;
+    commit_cv_.notify_all();
+}
+
+template <typename Key>
+void BasicFileStore<Key>::completeAsyncCommit(const std::shared_ptr<PendingCommit> &commit, bool ok)
+{
+    finishCommit(*commit, ok);
+    driveCommits(true);
+    endAsyncOp();
+}
 
-    if (!index_file)
+template <typename Key>
+template <typename Visitor>
+void BasicFileStore<Key>::forEachRecord(const WriteRequest &request, Visitor &&visitor)
+{
+    if (request.batch)
     {
-        std::cerr << "Failed to save index to file!" << std::endl;
-        return;
+        for (const auto &op : request.batch->operations())
+        {
+            visitor(op.key, op.tombstone ? nullptr : &op.value);
+        }
+    }
+    else
+    {
+        visitor(request.key, request.tombstone ? nullptr : request.value);
     }
+}
 
-    // 保存当前索引大小
-    size_t index_size = index_.size();
-    index_file.write(reinterpret_cast<const char *>(&index_size), sizeof(index_size));
+template <typename Key>
+bool BasicFileStore<Key>::isBlobRecord(const WriteRequest &request, const std::string *value) const
+{
+    return value && !request.batch && options_.blob_value_threshold > 0 && value->size() >= options_.blob_value_threshold;
+}
 
-    // 保存所有对象的元数据
-    for (const auto &pair : index_)
+// 将一批请求编码为连续的记录，确定写入的段与偏移；原子批次编码为一个批次帧。
+// 大 value 的记录编码到 blob_buffer，与主日志的记录共用序列号
+template <typename Key>
+bool BasicFileStore<Key>::prepareCommit(PendingCommit &commit)
+{
+    commit.first_seq = next_seq_;
+    for (const WriteRequest *req : commit.requests)
     {
-        const ObjectMeta &meta = pair.second;
-        index_file.write(reinterpret_cast<const char *>(&meta), sizeof(ObjectMeta));
+        size_t frame_start = req->batch ? beginBatchRecord(commit.buffer) : 0;
+        uint64_t frame_seq = next_seq_;
+        forEachRecord(*req, [&](const Key &key, const std::string *value)
+                      {
+            if (isBlobRecord(*req, value)) {
+                appendRecord(commit.blob_buffer, Traits::data(key), Traits::size(key), value->data(), value->size(), next_seq_++, 0);
+            } else if (value) {
+                appendRecord(commit.buffer, Traits::data(key), Traits::size(key), value->data(), value->size(), next_seq_++, 0);
+            } else {
+                appendRecord(commit.buffer, Traits::data(key), Traits::size(key), nullptr, 0, next_seq_++, RECORD_FLAG_TOMBSTONE);
+            } });
+        if (req->batch)
+        {
+            finishBatchRecord(commit.buffer, frame_start, frame_seq);
+        }
     }
 
-    index_file.close();
+    // 只有令牌持有者会追加，写入成功后才推进段大小，失败时日志中不会留下空洞
+    commit.segment = appendTarget(false, commit.buffer.size());
+    commit.offset = commit.segment ? commit.segment->size.load() : 0;
+    if (!commit.blob_buffer.empty())
+    {
+        commit.blob_segment = appendTarget(true, commit.blob_buffer.size());
+        commit.blob_offset = commit.blob_segment ? commit.blob_segment->size.load() : 0;
+    }
+    return commit.segment && (commit.blob_buffer.empty() || commit.blob_segment);
 }
 
-void FileStore::printFileContext()
+// 当前段放不下这一批时滚动到新段；单批超过段大小时独占一个段。调用者持有提交令牌
+template <typename Key>
+std::shared_ptr<Segment> BasicFileStore<Key>::appendTarget(bool blob, size_t bytes)
 {
-    std::ifstream file(file_path_);
-    if (!file.is_open())
+    std::shared_ptr<Segment> seg;
     {
-        std::cerr << "Failed to open: " << file_path_ << std::endl;
-        return;
+        std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+        seg = blob ? blob_active_ : active_;
+    }
+    if (blob && !seg)
+    {
+        rollSegment(true);
+        std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+        return blob_active_;
+    }
+    if (seg && seg->size > DATA_FILE_HEADER_SIZE && seg->size + bytes > segmentCapacity(*seg))
+    {
+        rollSegment(blob);
+        std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+        std::shared_ptr<Segment> next = blob ? blob_active_ : active_;
+        return next != seg ? next : nullptr;
+    }
+    return seg;
+}
+
+// 发布写入结果并通知请求者：同步请求置位 done，异步请求调用回调
+template <typename Key>
+void BasicFileStore<Key>::finishCommit(PendingCommit &commit, bool ok)
+{
+    commit_batch_count_++;
+    if (!ok)
+    {
+        std::cerr << "Failed to write to file." << std::endl;
+        next_seq_ = commit.first_seq;
+        for (WriteRequest *req : commit.requests)
+        {
+            req->success = false;
+        }
+    }
+    else
+    {
+        // 按队列顺序发布索引，同一 key 的后写入者覆盖先写入者。
+        // 段大小与已发布序列号在同一临界区内推进，检查点因此总能看到一致的日志位置。
+        // 每条记录按 isBlobRecord 写入主日志段或 blob 文件，两者各自推进写入位置
+        Segment *seg = commit.segment.get();
+        Segment *blob = commit.blob_segment.get();
+        size_t offset = commit.offset;
+        size_t blob_offset = commit.blob_offset;
+        for (Segment *target : {seg, blob})
+        {
+            if (target && commit.first_seq < target->min_seq)
+            {
+                target->min_seq = commit.first_seq; // 日志段内序列号递增，第一批即最小值
+            }
+        }
+        if (seg->hint_tracked || (blob && blob->hint_tracked))
+        {
+            uint64_t seq = commit.first_seq;
+            size_t hint_offset = commit.offset;
+            size_t blob_hint_offset = commit.blob_offset;
+            for (const WriteRequest *req : commit.requests)
+            {
+                hint_offset += req->batch ? RECORD_HEADER_SIZE : 0;
+                forEachRecord(*req, [&](const Key &key, const std::string *value)
+                              {
+                    bool to_blob = isBlobRecord(*req, value);
+                    Segment *target = to_blob ? blob : seg;
+                    size_t &cursor = to_blob ? blob_hint_offset : hint_offset;
+                    uint32_t value_size = value ? static_cast<uint32_t>(value->size()) : 0;
+                    if (target->hint_tracked) {
+                        appendHintEntry(target->hint, HintEntry{key, cursor, value_size, seq,
+                                                                static_cast<uint8_t>(value ? 0 : RECORD_FLAG_TOMBSTONE)});
+                        target->hint_entries++;
+                    }
+                    seq++;
+                    cursor += recordSize(value_size, Traits::size(key)); });
+            }
+        }
+        std::unique_lock<std::shared_mutex> index_lock(index_mtx_);
+        seg->size += commit.buffer.size();
+        if (blob)
+        {
+            blob->size += commit.blob_buffer.size();
+        }
+        published_seq_ = next_seq_;
+        bytes_since_checkpoint_ += commit.buffer.size() + commit.blob_buffer.size();
+        for (WriteRequest *req : commit.requests)
+        {
+            if (req->batch)
+            {
+                // 帧头不被索引引用，直接计为垃圾
+                seg->dead_bytes += RECORD_HEADER_SIZE;
+                offset += RECORD_HEADER_SIZE;
+            }
+            bool success = true;
+            forEachRecord(*req, [&](const Key &key, const std::string *value)
+                          {
+                size_t record_size = recordSize(value ? value->size() : 0, Traits::size(key));
+                ObjectMeta old;
+                bool found = index_.find(key, old);
+                bool exists = found && !old.deleted;
+
+                bool to_blob = isBlobRecord(*req, value);
+                Segment *target = to_blob ? blob : seg;
+                size_t &cursor = to_blob ? blob_offset : offset;
+
+                if (!value) {
+                    // 墓碑在被压缩安全丢弃之前仍被索引引用，计为有效数据；key 不存在时直接计为垃圾
+                    success = exists;
+                    if (exists) {
+                        markDead(old); // 旧值成为垃圾
+                        target->live_bytes += record_size;
+                        index_.insert(ObjectMeta{key, target->id, cursor, 0, true});
+                        if (options_.ordered_index) {
+                            ordered_keys_.erase(key);
+                        }
+                    } else {
+                        target->dead_bytes += record_size;
+                    }
+                } else {
+                    if (found) {
+                        markDead(old); // 旧值或旧墓碑成为垃圾
+                    }
+                    target->live_bytes += record_size;
+                    ObjectMeta meta{key, target->id, cursor, value->size(), false};
+                    if (admitInline(value->size())) {
+                        meta.value = value->data();
+                    }
+                    index_.insert(meta);
+                    if (options_.ordered_index && !exists) {
+                        ordered_keys_.insert(key);
+                    }
+                }
+                cursor += record_size; });
+            // 批次中删除不存在的 key 不算失败
+            req->success = req->batch || success;
+        }
+    }
+
+    if (ok && options_.sync_mode != SyncMode::PerWrite)
+    {
+        unsynced_bytes_ += commit.buffer.size() + commit.blob_buffer.size();
+        if (options_.sync_mode == SyncMode::Interval && options_.sync_interval_bytes > 0 &&
+            unsynced_bytes_ >= options_.sync_interval_bytes)
+        {
+            sync_cv_.notify_one();
+        }
+    }
+
+    // 同步请求置位 done 后可能立即被请求者销毁，先把异步请求挑出来
+    std::vector<WriteRequest *> async_requests;
+    {
+        std::lock_guard<std::mutex> lock(commit_mtx_);
+        for (WriteRequest *req : commit.requests)
+        {
+            if (req->callback)
+            {
+                async_requests.push_back(req);
+            }
+            else
+            {
+                req->done = true;
+            }
+        }
     }
+    commit_cv_.notify_all();
 
-    std::string line;
-    std::cout << "[File context] " << std::endl;
-    while (std::getline(file, line))
+    for (WriteRequest *req : async_requests)
     {
-        std::cout << line << std::endl;
+        req->callback(req->success);
+        delete req;
+        endAsyncOp();
     }
 
-    file.close();
+    // 追加量达到阈值时请 GC 线程保存检查点，限制崩溃后需要重放的日志长度；
+    // leader 不在持有令牌时编码和写出整个索引
+    size_t interval = std::max(options_.checkpoint_interval_bytes, last_checkpoint_size_.load());
+    if (options_.checkpoint_interval_bytes > 0 && bytes_since_checkpoint_ >= interval &&
+        !checkpoint_requested_.exchange(true))
+    {
+        std::lock_guard<std::mutex> lock(gc_wait_mtx_);
+        gc_cv_.notify_one();
+    }
 }
+
+// 同步方法 get
+template <typename Key>
+std::string BasicFileStore<Key>::get(const Key &key)
+{
+    // 查找索引，在索引锁内取得段的引用：压缩移除旧段也在索引独占锁内完成，
+    // 持有引用即可在释放锁后继续读取，即使段文件已被删除
+    ObjectMeta meta;
+    std::shared_ptr<Segment> seg;
+    {
+        std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+        if (!index_.find(key, meta) || meta.deleted)
+        {
+            return ""; // Key 未找到或已被删除
+        }
+        if (meta.value)
+        {
+            // 内联的 value 只在索引锁内有效，拷贝后返回，不访问磁盘
+            inline_hits_++;
+            return std::string(meta.value, meta.size);
+        }
+        seg = findSegment(meta.segment_id);
+    }
+    return readValue(seg, meta);
+}
+
+template <typename Key>
+std::string BasicFileStore<Key>::readValue(const std::shared_ptr<Segment> &seg, const ObjectMeta &meta)
+{
+    // 定位读取，读者之间、读者与写入者以及压缩之间互不阻塞；
+    // 映射覆盖该记录时直接拷贝，否则回退到 pread
+    std::string value;
+    value.resize(meta.size);
+    size_t value_offset = meta.offset + recordValueOffset(Traits::size(meta.key));
+    if (seg && seg->map && value_offset + meta.size <= seg->map_size)
+    {
+        std::memcpy(&value[0], seg->map + value_offset, meta.size);
+    }
+    else if (!seg || !preadFull(seg->fd, &value[0], meta.size, value_offset))
+    {
+        std::cerr << "Failed to read from file." << std::endl;
+        return "";
+    }
+    read_count_++;
+
+    return value;
+}
+
+// 异步方法 get：映射命中或 io_uring 不可用时直接读取，否则提交异步读
+template <typename Key>
+void BasicFileStore<Key>::asyncGet(const Key &key, std::function<void(std::string)> callback)
+{
+    ObjectMeta meta;
+    std::shared_ptr<Segment> seg;
+    std::string inline_value;
+    {
+        std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+        bool found = index_.find(key, meta) && !meta.deleted;
+        if (found && meta.value)
+        {
+            inline_hits_++;
+            inline_value.assign(meta.value, meta.size);
+        }
+        else if (found)
+        {
+            seg = findSegment(meta.segment_id);
+        }
+    }
+    // 回调不在索引锁内执行
+    if (!seg)
+    {
+        callback(std::move(inline_value));
+        return;
+    }
+
+    size_t value_offset = meta.offset + recordValueOffset(Traits::size(meta.key));
+    bool mapped = seg && seg->map && value_offset + meta.size <= seg->map_size;
+    if (io_ring_ && seg && !mapped && meta.size > 0)
+    {
+        // 回调持有段的引用，读取完成前段文件不会被关闭
+        auto value = std::make_shared<std::string>(meta.size, '\0');
+        beginAsyncOp();
+        bool submitted = io_ring_->read(seg->fd, &(*value)[0], meta.size, value_offset,
+                                        [this, seg, value, value_offset, callback](int res)
+                                        {
+                                            size_t done = res > 0 ? static_cast<size_t>(res) : 0;
+                                            if (res < 0 || !preadFull(seg->fd, &(*value)[done], value->size() - done, value_offset + done))
+                                            {
+                                                std::cerr << "Failed to read from file." << std::endl;
+                                                callback("");
+                                            }
+                                            else
+                                            {
+                                                read_count_++;
+                                                callback(std::move(*value));
+                                            }
+                                            endAsyncOp();
+                                        });
+        if (submitted)
+        {
+            return;
+        }
+        endAsyncOp();
+    }
+    callback(readValue(seg, meta));
+}
+
+template <typename Key>
+void BasicFileStore<Key>::asyncPut(const Key &key, const std::string &value, std::function<void(bool)> callback)
+{
+    if (!io_ring_ || !Traits::valid(key))
+    {
+        callback(put(key, value));
+        return;
+    }
+
+    auto *request = new WriteRequest{key, nullptr};
+    request->owned_value = value;
+    request->value = &request->owned_value;
+    request->callback = std::move(callback);
+    beginAsyncOp();
+    submitWritesAsync({request});
+}
+
+template <typename Key>
+void BasicFileStore<Key>::asyncDel(const Key &key, std::function<void(bool)> callback)
+{
+    if (!io_ring_)
+    {
+        callback(del(key));
+        return;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+        ObjectMeta meta;
+        if (!index_.find(key, meta) || meta.deleted)
+        {
+            index_lock.unlock();
+            callback(false);
+            return;
+        }
+    }
+
+    auto *request = new WriteRequest{key, nullptr};
+    request->tombstone = true;
+    request->callback = std::move(callback);
+    beginAsyncOp();
+    submitWritesAsync({request});
+}
+
+template <typename Key>
+bool BasicFileStore<Key>::hasAsyncIo() const
+{
+    return io_ring_ != nullptr;
+}
+
+template <typename Key>
+void BasicFileStore<Key>::beginAsyncOp()
+{
+    std::lock_guard<std::mutex> lock(async_mtx_);
+    async_pending_++;
+}
+
+template <typename Key>
+void BasicFileStore<Key>::endAsyncOp()
+{
+    // 持锁通知：计数归零后析构函数可能立即销毁条件变量
+    std::lock_guard<std::mutex> lock(async_mtx_);
+    async_pending_--;
+    async_cv_.notify_all();
+}
+
+// 同步方法 del
+template <typename Key>
+bool BasicFileStore<Key>::del(const Key &key)
+{
+    // 从索引中查找
+    {
+        std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+        ObjectMeta meta;
+        if (!index_.find(key, meta) || meta.deleted)
+        {
+            return false; // Key 未找到或已被删除
+        }
+    }
+
+    // 追加墓碑记录，索引在 leader 发布时标记为已删除
+    WriteRequest request{key, nullptr};
+    request.tombstone = true;
+    return submitWrites(&request, 1);
+}
+
+// 清理无效数据，返回回收的字节数
+template <typename Key>
+size_t BasicFileStore<Key>::garbageCollect()
+{
+    std::lock_guard<std::mutex> gc_lock(gc_mtx_);
+
+    // 当前段垃圾过多时先封存，使其也能被压缩；只在切换段时短暂持有提交令牌，
+    // 期间积累的写入在交还令牌时由本线程写出
+    {
+        acquireCommitToken();
+        std::shared_ptr<Segment> active;
+        {
+            std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+            active = active_;
+        }
+        size_t active_data = active ? active->size - DATA_FILE_HEADER_SIZE : 0;
+        if (active_data > 0 && active->dead_bytes >= options_.compact_garbage_ratio * active_data)
+        {
+            rollSegment();
+        }
+        driveCommits(false);
+    }
+
+    // 主日志与 blob 文件分别挑选、分别压缩，主日志的压缩不会拷贝大 value
+    std::vector<std::shared_ptr<Segment>> victims = pickCompactionVictims(false);
+    std::vector<std::shared_ptr<Segment>> blob_victims = pickCompactionVictims(true);
+    if (victims.empty() && blob_victims.empty())
+    {
+        gc_stats_.skipped++;
+        return 0;
+    }
+
+    size_t reclaimed = 0;
+    for (const auto &group : {victims, blob_victims})
+    {
+        if (!group.empty())
+        {
+            reclaimed += compactSegments(group);
+        }
+    }
+    gc_stats_.runs++;
+    gc_stats_.last_reclaimed_bytes = reclaimed;
+    gc_stats_.total_reclaimed_bytes += reclaimed;
+    return reclaimed;
+}
+
+// 挑选垃圾比例达到阈值的封存段，垃圾比例最高的优先。
+// blob 文件使用自己的阈值：重写大 value 的代价高，通常让它积累更多垃圾后再回收
+template <typename Key>
+std::vector<std::shared_ptr<Segment>> BasicFileStore<Key>::pickCompactionVictims(bool blob)
+{
+    double threshold = blob ? options_.blob_gc_garbage_ratio : options_.compact_garbage_ratio;
+    std::vector<std::pair<double, std::shared_ptr<Segment>>> candidates;
+    {
+        std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+        for (const auto &entry : segments_)
+        {
+            const std::shared_ptr<Segment> &seg = entry.second;
+            size_t data = seg->size - DATA_FILE_HEADER_SIZE;
+            if (!seg->sealed || seg->blob != blob || data == 0)
+            {
+                continue;
+            }
+            double ratio = static_cast<double>(seg->dead_bytes) / data;
+            if (ratio >= threshold)
+            {
+                candidates.emplace_back(ratio, seg);
+            }
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b)
+              { return a.first > b.first; });
+
+    std::vector<std::shared_ptr<Segment>> victims;
+    for (size_t i = 0; i < candidates.size() && i < options_.max_compact_segments; ++i)
+    {
+        victims.push_back(candidates[i].second);
+    }
+    return victims;
+}
+
+// 在线压缩选中的段（调用者持有 gc_mtx_），返回回收的字节数
+// 拷贝阶段只在批量检查记录是否有效时短暂持有索引共享锁，读写照常进行；
+// 随后在一个短的独占临界区内合并：只有位置在拷贝期间未变化的索引项才指向新位置，
+// 其余拷贝直接计为新段的垃圾。已删除 key 的墓碑不再拷贝，其索引项一并移除。
+// 只读取被选中的段，I/O 与垃圾所在的段成正比，而不是与整个数据集成正比。
+// 选中的段按 compaction_threads 分组并行拷贝，每组写入自己的输出段。
+template <typename Key>
+size_t BasicFileStore<Key>::compactSegments(const std::vector<std::shared_ptr<Segment>> &victims)
+{
+    // 墓碑只有在其他段中不可能还有该 key 的更早记录时才能丢弃：
+    // 其序列号须小于所有保留段中的最小序列号。此后新建的段序列号只会更大
+    uint64_t seq_floor = UINT64_MAX;
+    {
+        std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+        for (const auto &entry : segments_)
+        {
+            bool is_victim = std::any_of(victims.begin(), victims.end(), [&entry](const std::shared_ptr<Segment> &victim)
+                                         { return victim->id == entry.first; });
+            if (!is_victim)
+            {
+                seq_floor = std::min<uint64_t>(seq_floor, entry.second->min_seq);
+            }
+        }
+    }
+
+    size_t workers = std::min(std::max<size_t>(options_.compaction_threads, 1), victims.size());
+    std::vector<CompactionResult> results(workers);
+    auto work = [&](size_t w)
+    {
+        for (size_t i = w; i < victims.size() && results[w].ok; i += workers)
+        {
+            results[w].ok = copyLiveRecords(*victims[i], seq_floor, results[w]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; ++w)
+    {
+        threads.emplace_back(work, w);
+    }
+    work(0);
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::vector<std::shared_ptr<Segment>> outputs;
+    std::vector<CompactionMove> moves;
+    std::vector<ObjectMeta> tombstones;
+    bool ok = true;
+    for (CompactionResult &result : results)
+    {
+        ok = ok && result.ok;
+        outputs.insert(outputs.end(), result.outputs.begin(), result.outputs.end());
+        moves.insert(moves.end(), result.moves.begin(), result.moves.end());
+        tombstones.insert(tombstones.end(), result.tombstones.begin(), result.tombstones.end());
+    }
+
+    // 持久化模式下先同步输出段：检查点引用它们、旧段被删除之前数据必须已落盘
+    for (const auto &seg : outputs)
+    {
+        if (ok && options_.sync_mode != SyncMode::None)
+        {
+            ok = syncSegment(*seg);
+        }
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Failed to copy object during compaction." << std::endl;
+        for (const auto &seg : outputs)
+        {
+            std::remove((segmentPath(seg->id, seg->blob) + TEMP_FILE_SUFFIX).c_str());
+        }
+        return 0;
+    }
+
+    // 输出段已写完，发布前写出提示文件，恢复时无需扫描其中的 value；
+    // 之后把输出段重命名为正式的段文件名，此前崩溃时打开存储会删除这些未发布的输出
+    for (const auto &seg : outputs)
+    {
+        writeHintFile(*seg);
+    }
+    for (const auto &seg : outputs)
+    {
+        std::string path = segmentPath(seg->id, seg->blob);
+        if (std::rename((path + TEMP_FILE_SUFFIX).c_str(), path.c_str()) != 0)
+        {
+            std::cerr << "Failed to publish compaction output: " << path << std::endl;
+            return 0; // 已重命名的输出段包含的都是旧段中的记录副本，保留也不影响恢复
+        }
+    }
+    if (options_.sync_mode != SyncMode::None)
+    {
+        syncDirectory();
+    }
+
+    // 合并：短临界区内发布新段、更新仍未变化的索引项、移除旧段
+    {
+        std::unique_lock<std::shared_mutex> index_lock(index_mtx_);
+        std::unique_lock<std::shared_mutex> segments_lock(segments_mtx_);
+        for (const auto &seg : outputs)
+        {
+            segments_[seg->id] = seg;
+        }
+
+        std::unordered_map<uint32_t, Segment *> output_by_id;
+        for (const auto &seg : outputs)
+        {
+            output_by_id[seg->id] = seg.get();
+        }
+        for (const auto &move : moves)
+        {
+            Segment *seg = output_by_id[move.to.segment_id];
+            size_t record_size = recordSize(move.to.size, Traits::size(move.to.key));
+            ObjectMeta current;
+            if (index_.find(move.to.key, current) && current.segment_id == move.from_segment && current.offset == move.from_offset)
+            {
+                index_.relocate(move.to); // 只更新位置，保留内联的 value
+                seg->live_bytes += record_size;
+            }
+            else
+            {
+                seg->dead_bytes += record_size; // 拷贝期间被覆盖或删除
+            }
+        }
+        for (const auto &meta : tombstones)
+        {
+            ObjectMeta current;
+            if (index_.find(meta.key, current) && current.deleted && current.segment_id == meta.segment_id && current.offset == meta.offset)
+            {
+                index_.erase(meta.key);
+            }
+        }
+
+        for (const auto &victim : victims)
+        {
+            segments_.erase(victim->id);
+        }
+    }
+
+    // 先保存不再引用旧段的检查点，再删除旧段文件；仍在读取旧段的线程持有其引用，不受影响
+    saveIndex();
+    size_t victim_bytes = 0;
+    size_t output_bytes = 0;
+    for (const auto &victim : victims)
+    {
+        std::remove(segmentPath(victim->id, victim->blob).c_str());
+        std::remove((segmentPath(victim->id, victim->blob) + HINT_FILE_SUFFIX).c_str());
+        victim_bytes += victim->size;
+    }
+    for (const auto &seg : outputs)
+    {
+        output_bytes += seg->size;
+    }
+    return victim_bytes > output_bytes ? victim_bytes - output_bytes : 0;
+}
+
+// 把一个段的有效记录拷贝到 result 的输出段。记录位置优先取自提示文件，无需读取 value；
+// 没有提示文件时顺序扫描一遍段。提示项与扫描结果都按偏移递增，相邻的有效记录合并成一段连续区间，
+// 每个区间用 copyRange 直接在文件之间拷贝，value 不经过用户态缓冲区
+template <typename Key>
+bool BasicFileStore<Key>::copyLiveRecords(const Segment &victim, uint64_t seq_floor, CompactionResult &result)
+{
+    std::vector<HintEntry> records;
+    if (!loadHintFile(victim, [&records](const HintEntry &hint)
+                      { records.push_back(hint); }))
+    {
+        records.clear();
+        size_t end = scanSegment(victim, DATA_FILE_HEADER_SIZE, [&records](const RecordHeader &header, const Key &key, size_t offset, const char *)
+                                 { records.push_back(HintEntry{key, offset, header.value_size, header.seq, header.flags}); });
+        // 段内有无法解析的数据时放弃本次压缩，避免丢失其后的有效记录
+        if (end != victim.size)
+        {
+            std::cerr << "Segment " << victim.id << " is corrupt, skipping compaction." << std::endl;
+            return false;
+        }
+    }
+
+    // 当前区间：源段 [src, src + size) 拷贝到输出段的 dst
+    std::shared_ptr<Segment> out;
+    size_t out_end = 0; // 输出段中已分配的末尾（含尚未拷贝的区间）
+    size_t src = 0;
+    size_t dst = 0;
+    size_t size = 0;
+    auto flush = [&]()
+    {
+        if (size == 0)
+        {
+            return true;
+        }
+        bool copied = copyRange(victim.fd, src, out->fd, dst, size);
+        out->size = dst + size;
+        size = 0;
+        return copied;
+    };
+
+    for (size_t first = 0; first < records.size(); first += LIVE_CHECK_BATCH)
+    {
+        // 一次加锁检查一批记录是否仍被索引引用
+        size_t last = std::min(records.size(), first + LIVE_CHECK_BATCH);
+        std::vector<ObjectMeta> live;
+        {
+            std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+            for (size_t i = first; i < last; ++i)
+            {
+                ObjectMeta meta;
+                if (index_.find(records[i].key, meta) && meta.segment_id == victim.id && meta.offset == records[i].offset)
+                {
+                    live.push_back(meta);
+                }
+                else
+                {
+                    records[i].offset = SIZE_MAX; // 已被覆盖或删除的旧记录
+                }
+            }
+        }
+
+        auto meta = live.begin();
+        for (size_t i = first; i < last; ++i)
+        {
+            const HintEntry &record = records[i];
+            if (record.offset == SIZE_MAX)
+            {
+                continue;
+            }
+            ObjectMeta &current = *meta++;
+            if (current.deleted && record.seq < seq_floor)
+            {
+                result.tombstones.push_back(current);
+                continue;
+            }
+
+            size_t record_size = recordSize(record.value_size, Traits::size(record.key));
+            if (!out || (out_end > DATA_FILE_HEADER_SIZE && out_end + record_size > segmentCapacity(*out)))
+            {
+                if (out && !flush())
+                {
+                    return false;
+                }
+                out = createSegment(next_segment_id_++, victim.blob, true);
+                if (!out)
+                {
+                    return false;
+                }
+                out->sealed = true;
+                out_end = out->size;
+                result.outputs.push_back(out);
+            }
+            if (size > 0 && src + size != record.offset)
+            {
+                if (!flush())
+                {
+                    return false;
+                }
+            }
+            if (size == 0)
+            {
+                src = record.offset;
+                dst = out_end;
+            }
+            size += record_size;
+
+            ObjectMeta to = current;
+            to.value = nullptr;
+            to.segment_id = out->id;
+            to.offset = out_end;
+            result.moves.push_back(CompactionMove{victim.id, record.offset, to});
+            if (record.seq < out->min_seq)
+            {
+                out->min_seq = record.seq;
+            }
+            if (out->hint_tracked)
+            {
+                appendHintEntry(out->hint, HintEntry{record.key, out_end, record.value_size, record.seq, record.flags});
+                out->hint_entries++;
+            }
+            out_end += record_size;
+        }
+    }
+    return flush();
+}
+
+template <typename Key>
+std::string BasicFileStore<Key>::segmentPath(uint32_t id, bool blob) const
+{
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), ".%08u", id);
+    return file_path_ + suffix + (blob ? BLOB_FILE_SUFFIX : "");
+}
+
+template <typename Key>
+std::shared_ptr<Segment> BasicFileStore<Key>::createSegment(uint32_t id, bool blob, bool temp)
+{
+    auto seg = std::make_shared<Segment>();
+    seg->id = id;
+    seg->blob = blob;
+    std::string path = segmentPath(id, blob);
+    std::remove((path + HINT_FILE_SUFFIX).c_str()); // 崩溃遗留的同名提示文件
+    if (temp)
+    {
+        path += TEMP_FILE_SUFFIX;
+    }
+    seg->fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (seg->fd < 0)
+    {
+        std::cerr << "Failed to create segment file: " << path << std::endl;
+        return nullptr;
+    }
+
+    char header[DATA_FILE_HEADER_SIZE];
+    encodeFileHeader(header, id);
+    if (!pwriteFull(seg->fd, header, sizeof(header), 0))
+    {
+        std::cerr << "Failed to initialize segment file: " << path << std::endl;
+        return nullptr;
+    }
+    seg->size = DATA_FILE_HEADER_SIZE;
+    seg->hint_tracked = options_.hint_files;
+    if (!temp && options_.sync_mode != SyncMode::None)
+    {
+        syncDirectory(); // 段文件的目录项落盘，之后同步的数据才能在崩溃后找到
+    }
+    mapSegment(*seg);
+    return seg;
+}
+
+// 按段大小上限映射，当前段后续追加的数据无需重新映射即可读取；
+// 映射超出文件末尾的部分不会被访问，因为只读取已发布的记录
+template <typename Key>
+void BasicFileStore<Key>::mapSegment(Segment &segment)
+{
+    if (!options_.use_mmap)
+    {
+        return;
+    }
+    size_t length = std::max(segment.size.load(), segmentCapacity(segment));
+    void *addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, segment.fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        std::cerr << "Failed to mmap segment " << segment.id << ", falling back to pread." << std::endl;
+        return;
+    }
+    ::madvise(addr, length, MADV_RANDOM);
+    segment.map = static_cast<char *>(addr);
+    segment.map_size = length;
+}
+
+template <typename Key>
+size_t BasicFileStore<Key>::segmentCapacity(const Segment &segment) const
+{
+    return segment.blob ? options_.blob_file_size : options_.segment_size;
+}
+
+template <typename Key>
+std::shared_ptr<Segment> BasicFileStore<Key>::findSegment(uint32_t id)
+{
+    std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+    auto it = segments_.find(id);
+    return it == segments_.end() ? nullptr : it->second;
+}
+
+// 封存当前段并切换到新段（调用者持有提交令牌）
+template <typename Key>
+void BasicFileStore<Key>::rollSegment(bool blob)
+{
+    std::shared_ptr<Segment> seg = createSegment(next_segment_id_++, blob);
+    if (!seg)
+    {
+        return;
+    }
+
+    std::shared_ptr<Segment> sealed;
+    {
+        std::unique_lock<std::shared_mutex> lock(segments_mtx_);
+        std::shared_ptr<Segment> &active = blob ? blob_active_ : active_;
+        if (active)
+        {
+            active->sealed = true;
+        }
+        sealed = active;
+        segments_[seg->id] = seg;
+        active = seg;
+    }
+
+    // 封存段此后不再变化：Interval 模式下先同步其剩余数据，再写出它的提示文件
+    if (sealed)
+    {
+        if (options_.sync_mode == SyncMode::Interval)
+        {
+            syncSegment(*sealed);
+        }
+        writeHintFile(*sealed);
+    }
+}
+
+template <typename Key>
+void BasicFileStore<Key>::writeHintFile(Segment &segment)
+{
+    if (!segment.hint_tracked)
+    {
+        return;
+    }
+
+    HintFileHeader header{segment.id, segment.size, segment.min_seq, segment.hint_entries};
+    std::string data(HINT_FILE_HEADER_SIZE, '\0');
+    encodeHintHeader(&data[0], header, HINT_VERSION);
+    data.append(segment.hint);
+    uint32_t checksum = crc32(data.data(), data.size());
+    data.append(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+    std::string().swap(segment.hint);
+    segment.hint_entries = 0;
+
+    // 与检查点相同，先写临时文件再原子替换
+    std::string hint_path = segmentPath(segment.id, segment.blob) + HINT_FILE_SUFFIX;
+    std::string temp_path = hint_path + ".tmp";
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && pwriteFull(fd, data.data(), data.size(), 0) &&
+              (options_.sync_mode == SyncMode::None || ::fdatasync(fd) == 0);
+    if (fd >= 0 && ::close(fd) != 0)
+    {
+        ok = false;
+    }
+    if (!ok || std::rename(temp_path.c_str(), hint_path.c_str()) != 0)
+    {
+        std::cerr << "Failed to write hint file: " << hint_path << std::endl;
+        std::remove(temp_path.c_str());
+    }
+}
+
+template <typename Key>
+bool BasicFileStore<Key>::readHintHeader(const Segment &segment, HintFileHeader &header)
+{
+    std::string hint_path = segmentPath(segment.id, segment.blob) + HINT_FILE_SUFFIX;
+    int fd = ::open(hint_path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    char data[HINT_FILE_HEADER_SIZE];
+    off_t file_size = ::lseek(fd, 0, SEEK_END);
+    bool valid = file_size > 0 && preadFull(fd, data, sizeof(data), 0);
+    ::close(fd);
+    return valid && decodeHintHeader(data, static_cast<size_t>(file_size), header, HINT_VERSION) &&
+           header.segment_id == segment.id && header.data_end == segment.size;
+}
+
+template <typename Key>
+bool BasicFileStore<Key>::loadHintFile(const Segment &segment, const std::function<void(const HintEntry &)> &visitor)
+{
+    std::string hint_path = segmentPath(segment.id, segment.blob) + HINT_FILE_SUFFIX;
+    int fd = ::open(hint_path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    std::string data;
+    off_t file_size = ::lseek(fd, 0, SEEK_END);
+    bool valid = file_size > 0;
+    if (valid)
+    {
+        data.resize(static_cast<size_t>(file_size));
+        valid = preadFull(fd, &data[0], data.size(), 0);
+    }
+    ::close(fd);
+
+    HintFileHeader header;
+    valid = valid && decodeHintHeader(data.data(), data.size(), header, HINT_VERSION) &&
+            header.segment_id == segment.id && header.data_end == segment.size;
+    if (valid)
+    {
+        uint32_t checksum;
+        size_t body_size = data.size() - HINT_FILE_TRAILER_SIZE;
+        std::memcpy(&checksum, data.data() + body_size, sizeof(checksum));
+        valid = crc32(data.data(), body_size) == checksum;
+    }
+    if (!valid)
+    {
+        std::cerr << "Ignoring invalid hint file: " << hint_path << std::endl;
+        return false;
+    }
+
+    const char *p = data.data() + HINT_FILE_HEADER_SIZE;
+    const char *end = data.data() + data.size() - HINT_FILE_TRAILER_SIZE;
+    HintEntry entry{};
+    for (uint64_t i = 0; i < header.entry_count; ++i)
+    {
+        if (!decodeHintEntry(p, end, entry))
+        {
+            std::cerr << "Ignoring invalid hint file: " << hint_path << std::endl;
+            return false;
+        }
+        visitor(entry);
+    }
+    return true;
+}
+
+// 索引项被覆盖或删除时，把它引用的记录计入所在段的垃圾
+template <typename Key>
+void BasicFileStore<Key>::markDead(const ObjectMeta &meta)
+{
+    std::shared_ptr<Segment> seg = findSegment(meta.segment_id);
+    if (seg)
+    {
+        size_t record_size = recordSize(meta.size, Traits::size(meta.key));
+        seg->live_bytes -= record_size;
+        seg->dead_bytes += record_size;
+    }
+}
+
+template <typename Key>
+size_t BasicFileStore<Key>::scanSegment(const Segment &segment, size_t start, const RecordVisitor &visitor)
+{
+    std::string buffer;
+    size_t buffer_pos = start; // buffer[0] 对应的文件偏移
+    size_t cursor = 0;         // buffer 中已解析到的位置
+    size_t limit = segment.size;
+
+    while (true)
+    {
+        RecordHeader header;
+        int rc = parseRecord(buffer.data() + cursor, buffer.size() - cursor, header);
+        if (rc > 0 && (header.flags & RECORD_FLAG_BATCH))
+        {
+            // 批次帧的校验和已覆盖全部内部记录：先完整解析一遍，再依次访问，损坏的帧一条也不访问
+            const char *frame = buffer.data() + cursor + RECORD_HEADER_SIZE;
+            size_t frame_size = header.value_size;
+            std::vector<std::pair<RecordHeader, Key>> records;
+            for (size_t pos = 0; rc > 0 && pos < frame_size;)
+            {
+                RecordHeader inner;
+                Key key{};
+                bool valid = parseRecord(frame + pos, frame_size - pos, inner) > 0 && !(inner.flags & RECORD_FLAG_BATCH) &&
+                             Traits::decode(frame + pos + RECORD_HEADER_SIZE, inner.key_size, key);
+                rc = valid ? 1 : -1;
+                records.emplace_back(inner, std::move(key));
+                pos += recordSize(inner.value_size, inner.key_size);
+            }
+            if (rc > 0)
+            {
+                size_t pos = 0;
+                for (const auto &record : records)
+                {
+                    size_t record_offset = cursor + RECORD_HEADER_SIZE + pos;
+                    visitor(record.first, record.second, buffer_pos + record_offset, buffer.data() + record_offset);
+                    pos += recordSize(record.first.value_size, record.first.key_size);
+                }
+                cursor += recordSize(header.value_size, header.key_size);
+                continue;
+            }
+        }
+        Key key{};
+        if (rc > 0 && !Traits::decode(buffer.data() + cursor + RECORD_HEADER_SIZE, header.key_size, key))
+        {
+            rc = -1; // key 与本实例的 key 类型不符，按损坏处理
+        }
+        if (rc > 0)
+        {
+            visitor(header, key, buffer_pos + cursor, buffer.data() + cursor);
+            cursor += recordSize(header.value_size, header.key_size);
+            continue;
+        }
+        if (rc < 0 || buffer_pos + buffer.size() >= limit)
+        {
+            break;
+        }
+
+        // 丢弃已解析的部分，继续读取下一块
+        buffer.erase(0, cursor);
+        buffer_pos += cursor;
+        cursor = 0;
+        size_t old_size = buffer.size();
+        size_t chunk = std::min(SCAN_CHUNK_SIZE, limit - buffer_pos - old_size);
+        buffer.resize(old_size + chunk);
+        if (!preadFull(segment.fd, &buffer[old_size], chunk, buffer_pos + old_size))
+        {
+            buffer.resize(old_size);
+            break;
+        }
+    }
+
+    return buffer_pos + cursor;
+}
+
+template <typename Key>
+bool BasicFileStore<Key>::preadFull(int fd, char *buf, size_t size, size_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::pread(fd, buf, size, offset);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        buf += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+// 优先用 copy_file_range 在内核中拷贝，文件系统支持时可直接共享数据块；
+// 内核或文件系统不支持（跨文件系统、老内核）时回退到大块的 pread / pwrite
+template <typename Key>
+bool BasicFileStore<Key>::copyRange(int from_fd, size_t from_offset, int to_fd, size_t to_offset, size_t size)
+{
+    while (size > 0)
+    {
+        loff_t in = static_cast<loff_t>(from_offset);
+        loff_t out = static_cast<loff_t>(to_offset);
+        ssize_t n = ::copy_file_range(from_fd, &in, to_fd, &out, size, 0);
+        if (n > 0)
+        {
+            from_offset += static_cast<size_t>(n);
+            to_offset += static_cast<size_t>(n);
+            size -= static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n == 0 || (errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP))
+        {
+            return false; // 源文件比预期短，或真正的 I/O 错误
+        }
+        break;
+    }
+
+    std::string buffer;
+    while (size > 0)
+    {
+        size_t chunk = std::min(size, SCAN_CHUNK_SIZE);
+        buffer.resize(chunk);
+        if (!preadFull(from_fd, &buffer[0], chunk, from_offset) || !pwriteFull(to_fd, buffer.data(), chunk, to_offset))
+        {
+            return false;
+        }
+        from_offset += chunk;
+        to_offset += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+template <typename Key>
+bool BasicFileStore<Key>::pwriteFull(int fd, const char *buf, size_t size, size_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::pwrite(fd, buf, size, offset);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        buf += n;
+        size -= n;
+        offset += n;
+    }
+    return true;
+}
+
+template <typename Key>
+void BasicFileStore<Key>::loadIndex()
+{
+    // 删除崩溃时尚未发布的压缩输出段，其中的记录在旧段中仍然存在
+    for (const auto &file : listSegmentFiles(file_path_, TEMP_FILE_SUFFIX))
+    {
+        std::cerr << "Removing unpublished compaction output: " << file.second.path << std::endl;
+        std::remove(file.second.path.c_str());
+    }
+
+    // 打开已有的段文件
+    for (const auto &file : listSegmentFiles(file_path_))
+    {
+        auto seg = std::make_shared<Segment>();
+        seg->id = file.first;
+        seg->blob = file.second.blob;
+        seg->fd = ::open(file.second.path.c_str(), O_RDWR);
+
+        char header[DATA_FILE_HEADER_SIZE];
+        uint64_t header_id = 0;
+        if (seg->fd < 0 || !preadFull(seg->fd, header, sizeof(header), 0) ||
+            !decodeFileHeader(header, header_id) || header_id != file.first)
+        {
+            std::cerr << "Ignoring unrecognized segment file: " << file.second.path << std::endl;
+            continue;
+        }
+        seg->size = ::lseek(seg->fd, 0, SEEK_END);
+        seg->sealed = true;
+        mapSegment(*seg);
+        segments_[seg->id] = seg;
+        next_segment_id_ = seg->id + 1;
+    }
+
+    // 加载检查点：整个文件一次读入后批量解码；引用了不存在的段或校验失败时视为失效，从所有段重建
+    bool have_checkpoint = false;
+    uint64_t checkpoint_active = 0;
+    uint64_t checkpoint_end = 0;
+    uint64_t checkpoint_blob = 0; // 检查点时的当前 blob 文件，0 表示没有
+    uint64_t checkpoint_blob_end = 0;
+    uint64_t checkpoint_next_segment = 0;
+    uint64_t checkpoint_seq = 0;
+    std::string index_file_path = file_path_ + INDEX_FILE_SUFFIX;
+    int index_fd = ::open(index_file_path.c_str(), O_RDONLY);
+    if (index_fd < 0)
+    {
+        std::cerr << "No existing index file found. Starting fresh." << std::endl;
+    }
+    else
+    {
+        std::string data;
+        off_t file_size = ::lseek(index_fd, 0, SEEK_END);
+        bool valid = file_size > 0;
+        if (valid)
+        {
+            data.resize(static_cast<size_t>(file_size));
+            valid = preadFull(index_fd, &data[0], data.size(), 0);
+        }
+        ::close(index_fd);
+
+        IndexFileHeader header;
+        valid = valid && decodeIndexHeader(data.data(), data.size(), header, INDEX_VERSION);
+        if (valid)
+        {
+            uint32_t checksum;
+            size_t body_size = data.size() - INDEX_FILE_TRAILER_SIZE;
+            std::memcpy(&checksum, data.data() + body_size, sizeof(checksum));
+            valid = crc32(data.data(), body_size) == checksum;
+        }
+
+        // 预先分配好槽，避免插入过程中反复扩容
+        if (valid)
+        {
+            index_.reserve(header.entry_count);
+        }
+        const char *p = data.data() + INDEX_FILE_HEADER_SIZE;
+        const char *end = valid ? data.data() + data.size() - INDEX_FILE_TRAILER_SIZE : p;
+        BasicIndexEntry<Key> entry{}; // 字节串 key 的索引项相对前一项做前缀压缩
+        for (uint64_t i = 0; valid && i < header.entry_count; ++i)
+        {
+            valid = decodeIndexEntry(p, end, entry) && segments_.count(entry.segment_id) > 0;
+            bool deleted = entry.flags & RECORD_FLAG_TOMBSTONE;
+            if (valid)
+            {
+                index_.insert(ObjectMeta{entry.key, entry.segment_id, entry.offset, entry.value_size, deleted});
+            }
+        }
+        valid = valid && p == end;
+
+        if (valid)
+        {
+            checkpoint_active = header.active_segment;
+            checkpoint_end = header.log_end;
+            checkpoint_next_segment = header.next_segment_id;
+            checkpoint_blob = header.blob_segment;
+            checkpoint_blob_end = header.blob_log_end;
+            auto active = segments_.find(checkpoint_active);
+            auto blob_active = segments_.find(checkpoint_blob);
+            valid = segments_.empty() || (active != segments_.end() && active->second->size >= checkpoint_end);
+            valid = valid && (checkpoint_blob == 0 || (blob_active != segments_.end() && blob_active->second->size >= checkpoint_blob_end));
+        }
+        if (valid)
+        {
+            have_checkpoint = true;
+            checkpoint_seq = header.next_seq;
+            next_seq_ = header.next_seq;
+        }
+        else
+        {
+            std::cerr << "Index checkpoint is stale or corrupt, rebuilding from segments." << std::endl;
+            index_.clear();
+            checkpoint_active = checkpoint_end = checkpoint_next_segment = 0;
+            checkpoint_blob = checkpoint_blob_end = 0;
+        }
+    }
+
+    // 重放检查点之后的日志：检查点时的当前段从检查点位置开始，之后创建的段整段重放。
+    // 压缩输出段中的记录保留原序列号，按序列号取每个 key 的最新记录。
+    // 整段重放的封存段优先读取提示文件，只有最新的段（未封存的尾部）需要扫描记录。
+    // 当前 blob 文件与主日志的当前段一样，从检查点记录的位置开始重放。
+    std::unordered_map<Key, uint64_t, KeyHash<Key>> replay_seq;
+    size_t replayed_bytes = 0;
+    uint32_t newest_segment = 0;
+    uint32_t newest_blob = 0;
+    for (const auto &entry : segments_)
+    {
+        // 只有会重放尾部的段才能继续追加：检查点之前创建的段中只有检查点时的当前段（或 blob 文件）会重放，
+        // 压缩输出段的 id 虽然可能更大，但重新打开后追加的记录在崩溃后不会被重放
+        bool replayed = !have_checkpoint || entry.first >= checkpoint_next_segment ||
+                        entry.first == (entry.second->blob ? checkpoint_blob : checkpoint_active);
+        if (replayed)
+        {
+            (entry.second->blob ? newest_blob : newest_segment) = entry.first;
+        }
+    }
+    for (auto &entry : segments_)
+    {
+        Segment &seg = *entry.second;
+        bool newest = seg.id == newest_segment || seg.id == newest_blob;
+        size_t start = DATA_FILE_HEADER_SIZE;
+        if (have_checkpoint)
+        {
+            if (seg.id == checkpoint_active)
+            {
+                start = checkpoint_end;
+            }
+            else if (seg.id == checkpoint_blob)
+            {
+                start = checkpoint_blob_end;
+            }
+            else if (seg.id < checkpoint_next_segment)
+            {
+                // 检查点已覆盖的段不读取记录，最小序列号取自提示文件头，没有时视为未知
+                HintFileHeader header;
+                seg.min_seq = readHintHeader(seg, header) ? header.min_seq : 0;
+                continue;
+            }
+        }
+
+        uint64_t segment_min_seq = UINT64_MAX;
+        auto apply = [&](const Key &key, uint64_t seq, uint8_t flags, size_t offset, uint32_t value_size)
+        {
+            segment_min_seq = std::min(segment_min_seq, seq);
+            if (seq >= next_seq_)
+            {
+                next_seq_ = seq + 1;
+            }
+            if (seq < checkpoint_seq)
+            {
+                return; // 已包含在检查点中
+            }
+            auto it = replay_seq.find(key);
+            if (it != replay_seq.end() && it->second >= seq)
+            {
+                return;
+            }
+            replay_seq[key] = seq;
+            bool tombstone = flags & RECORD_FLAG_TOMBSTONE;
+            index_.insert(ObjectMeta{key, seg.id, offset, tombstone ? 0 : value_size, tombstone});
+        };
+
+        bool full_replay = start == DATA_FILE_HEADER_SIZE;
+        if (full_replay && !newest &&
+            loadHintFile(seg, [&](const HintEntry &hint)
+                         { apply(hint.key, hint.seq, hint.flags, hint.offset, hint.value_size); }))
+        {
+            seg.min_seq = segment_min_seq;
+            replayed_bytes += seg.size - start;
+            continue;
+        }
+
+        // 整段扫描时顺便收集提示项：封存段随后补写提示文件，当前段在封存时写出
+        seg.hint_tracked = full_replay && options_.hint_files;
+        size_t end = scanSegment(seg, start, [&](const RecordHeader &header, const Key &key, size_t offset, const char *)
+                                 {
+            apply(key, header.seq, header.flags, offset, header.value_size);
+            if (seg.hint_tracked) {
+                appendHintEntry(seg.hint, HintEntry{key, offset, header.value_size, header.seq, header.flags});
+                seg.hint_entries++;
+            } });
+        seg.min_seq = full_replay ? segment_min_seq : 0;
+
+        // 截断末尾不完整的记录
+        if (end < seg.size)
+        {
+            std::cerr << "Truncating " << (seg.size - end) << " bytes of torn log tail in segment " << seg.id << "." << std::endl;
+            if (::ftruncate(seg.fd, end) != 0)
+            {
+                std::cerr << "Failed to truncate segment file." << std::endl;
+            }
+            seg.size = end;
+        }
+        replayed_bytes += end - start;
+        if (seg.hint_tracked && !newest)
+        {
+            writeHintFile(seg);
+        }
+    }
+    bytes_since_checkpoint_ = replayed_bytes;
+    published_seq_ = next_seq_;
+    if (next_segment_id_ < checkpoint_next_segment)
+    {
+        next_segment_id_ = static_cast<uint32_t>(checkpoint_next_segment);
+    }
+
+    // 最新的可重放段继续作为当前段，没有段时创建第一个段；blob 文件同样处理，没有可追加的 blob 文件时在第一次写入大 value 时创建
+    if (newest_segment == 0)
+    {
+        std::shared_ptr<Segment> seg = createSegment(next_segment_id_++);
+        if (seg)
+        {
+            segments_[seg->id] = seg;
+            newest_segment = seg->id;
+        }
+    }
+    if (newest_segment != 0)
+    {
+        active_ = segments_[newest_segment];
+        active_->sealed = false;
+    }
+    if (newest_blob != 0)
+    {
+        blob_active_ = segments_[newest_blob];
+        blob_active_->sealed = false;
+    }
+
+    // 根据索引重新计算各段的有效字节与垃圾字节，同时收集有序索引的 key
+    std::vector<Key> live_keys;
+    index_.forEach([&](const ObjectMeta &meta)
+                   {
+        auto it = segments_.find(meta.segment_id);
+        if (it != segments_.end())
+        {
+            it->second->live_bytes += recordSize(meta.size, Traits::size(meta.key));
+        }
+        if (options_.ordered_index && !meta.deleted)
+        {
+            live_keys.push_back(meta.key);
+        } });
+    if (options_.ordered_index)
+    {
+        std::sort(live_keys.begin(), live_keys.end());
+        ordered_keys_.assign(live_keys);
+    }
+    for (auto &entry : segments_)
+    {
+        Segment &seg = *entry.second;
+        seg.dead_bytes = seg.size - DATA_FILE_HEADER_SIZE - seg.live_bytes;
+    }
+    loadInlineValues();
+}
+
+// 内联的 value 不写入检查点，重启时按段和偏移合并读取回索引。
+// 读取量不超过内联预算，启动时间随之增加；开启时仅在构造期间调用，无需加锁
+template <typename Key>
+void BasicFileStore<Key>::loadInlineValues()
+{
+    if (options_.inline_value_max_size == 0)
+    {
+        return;
+    }
+    std::vector<ReadItem> items;
+    size_t bytes = 0;
+    index_.forEach([&](const ObjectMeta &meta)
+                   {
+        size_t cost = BasicIndexTable<Key>::inlineCost(meta.size);
+        if (meta.deleted || meta.size > inline_threshold_ || bytes + cost > options_.inline_value_budget) {
+            return;
+        }
+        auto it = segments_.find(meta.segment_id);
+        if (it != segments_.end()) {
+            bytes += cost;
+            items.push_back(ReadItem{meta, it->second, items.size()});
+        } });
+
+    std::vector<std::string> values(items.size());
+    readChunks(items, values);
+    for (const ReadItem &item : items)
+    {
+        if (item.ok)
+        {
+            ObjectMeta meta = item.meta;
+            meta.value = values[item.slot].data();
+            index_.insert(meta);
+        }
+    }
+}
+
+// 调用方持有索引独占锁。占用回落到预算一半以下时阈值逐步恢复，
+// 放入后会超出预算时把阈值减半到该 value 以下，之后更大的 value 不再内联
+template <typename Key>
+bool BasicFileStore<Key>::admitInline(size_t value_size)
+{
+    if (options_.inline_value_max_size == 0)
+    {
+        return false;
+    }
+    size_t used = index_.inlineBytes();
+    if (used < options_.inline_value_budget / 2 && inline_threshold_ < options_.inline_value_max_size)
+    {
+        inline_threshold_ = std::min(options_.inline_value_max_size, inline_threshold_ * 2 + 1);
+    }
+    if (value_size > inline_threshold_)
+    {
+        return false;
+    }
+    if (used + BasicIndexTable<Key>::inlineCost(value_size) > options_.inline_value_budget)
+    {
+        inline_threshold_ = value_size / 2;
+        return false;
+    }
+    return true;
+}
+
+template <typename Key>
+void BasicFileStore<Key>::saveIndex()
+{
+    // 索引共享锁下，段大小与已发布序列号和索引内容一致
+    std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mtx_);
+    std::shared_lock<std::shared_mutex> index_lock(index_mtx_);
+
+    // 滚动段时先分配 id 再切换当前段，先读下一个段 id 保证新段不会被检查点漏掉
+    uint32_t next_segment_id = next_segment_id_;
+    std::shared_ptr<Segment> active;
+    std::shared_ptr<Segment> blob_active;
+    {
+        std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+        active = active_;
+        blob_active = blob_active_;
+    }
+    if (!active)
+    {
+        return;
+    }
+
+    // 在锁内把检查点编码到一块连续的缓冲区，写文件时不再阻塞写入者的索引发布。
+    // 字节串 key 在锁内只拷贝索引项，解锁后再排序并做前缀压缩
+    IndexFileHeader header{index_.size(), active->id, active->size, next_segment_id, published_seq_,
+                           blob_active ? blob_active->id : 0u, blob_active ? blob_active->size.load() : 0u};
+    std::string data;
+    std::vector<ObjectMeta> metas;
+    if constexpr (FIXED_SIZE_KEYS)
+    {
+        data.assign(INDEX_FILE_HEADER_SIZE + index_.size() * INDEX_ENTRY_SIZE + INDEX_FILE_TRAILER_SIZE, '\0');
+        char *p = &data[INDEX_FILE_HEADER_SIZE];
+        index_.forEach([&p](const ObjectMeta &meta)
+                       {
+            IndexEntry entry{meta.key, meta.segment_id, meta.offset, static_cast<uint32_t>(meta.size),
+                             static_cast<uint8_t>(meta.deleted ? RECORD_FLAG_TOMBSTONE : 0)};
+            encodeIndexEntry(p, entry);
+            p += INDEX_ENTRY_SIZE; });
+    }
+    else
+    {
+        metas.reserve(index_.size());
+        index_.forEach([&metas](const ObjectMeta &meta)
+                       { metas.push_back(meta); });
+    }
+    size_t covered_bytes = bytes_since_checkpoint_; // 解锁后继续追加的字节留给下一个检查点
+    index_lock.unlock();
+
+    if constexpr (!FIXED_SIZE_KEYS)
+    {
+        std::sort(metas.begin(), metas.end(), [](const ObjectMeta &a, const ObjectMeta &b)
+                  { return a.key < b.key; });
+        data.assign(INDEX_FILE_HEADER_SIZE, '\0');
+        static const Key empty_key{};
+        const Key *prev_key = &empty_key;
+        for (const ObjectMeta &meta : metas)
+        {
+            appendIndexEntry(data, BasicIndexEntry<Key>{meta.key, meta.segment_id, meta.offset, static_cast<uint32_t>(meta.size),
+                                                        static_cast<uint8_t>(meta.deleted ? RECORD_FLAG_TOMBSTONE : 0)},
+                             *prev_key);
+            prev_key = &meta.key;
+        }
+        data.append(INDEX_FILE_TRAILER_SIZE, '\0');
+    }
+    encodeIndexHeader(&data[0], header, INDEX_VERSION);
+
+    size_t body_size = data.size() - INDEX_FILE_TRAILER_SIZE;
+    uint32_t checksum = crc32(data.data(), body_size);
+    std::memcpy(&data[body_size], &checksum, sizeof(checksum));
+
+    // 先写临时文件再原子替换，避免崩溃时留下半个检查点
+    std::string index_file_path = file_path_ + INDEX_FILE_SUFFIX;
+    std::string temp_path = index_file_path + ".tmp";
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && pwriteFull(fd, data.data(), data.size(), 0) &&
+              (options_.sync_mode == SyncMode::None || ::fdatasync(fd) == 0);
+    if (fd >= 0 && ::close(fd) != 0)
+    {
+        ok = false;
+    }
+    if (!ok || std::rename(temp_path.c_str(), index_file_path.c_str()) != 0)
+    {
+        std::cerr << "Failed to save index to file!" << std::endl;
+        return;
+    }
+    if (options_.sync_mode != SyncMode::None)
+    {
+        syncDirectory();
+    }
+    bytes_since_checkpoint_ -= covered_bytes;
+    last_checkpoint_size_ = data.size();
+}
+
+template <typename Key>
+void BasicFileStore<Key>::printFileContext()
+{
+    std::shared_lock<std::shared_mutex> lock(segments_mtx_);
+    for (const auto &entry : segments_)
+    {
+        std::ifstream file(segmentPath(entry.first, entry.second->blob));
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open: " << segmentPath(entry.first, entry.second->blob) << std::endl;
+            continue;
+        }
+
+        std::string line;
+        std::cout << "[File context] segment " << entry.first << std::endl;
+        while (std::getline(file, line))
+        {
+            std::cout << line << std::endl;
+        }
+    }
+}
+
+template class BasicFileStore<int>;
+template class BasicFileStore<std::string>;
@@ -0,0 +1,453 @@
+#include "index_table.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr size_t GROUP_WIDTH = 16;
+    constexpr int8_t CTRL_EMPTY = -128;
+    constexpr int8_t CTRL_DELETED = -2;
+    constexpr size_t MIN_CAPACITY = GROUP_WIDTH;
+    constexpr size_t MIGRATE_BATCH = 64; // 每次修改迁移的旧表槽数
+
+    int8_t h2(uint64_t hash)
+    {
+        return static_cast<int8_t>(hash & 0x7F);
+    }
+
+    // 组内控制字的匹配位图：第 i 位为 1 表示第 i 个槽满足条件
+    struct Group
+    {
+#if defined(__SSE2__)
+        __m128i ctrl;
+        explicit Group(const int8_t *p) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))) {}
+        uint32_t match(int8_t h) const
+        {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h))));
+        }
+        uint32_t matchEmpty() const
+        {
+            return match(CTRL_EMPTY);
+        }
+        uint32_t matchEmptyOrDeleted() const
+        {
+            // EMPTY 与 DELETED 均为负数，最高位即可区分
+            return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+        }
+#else
+        const int8_t *ctrl;
+        explicit Group(const int8_t *p) : ctrl(p) {}
+        uint32_t match(int8_t h) const
+        {
+            uint32_t bits = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i)
+            {
+                bits |= static_cast<uint32_t>(ctrl[i] == h) << i;
+            }
+            return bits;
+        }
+        uint32_t matchEmpty() const
+        {
+            return match(CTRL_EMPTY);
+        }
+        uint32_t matchEmptyOrDeleted() const
+        {
+            uint32_t bits = 0;
+            for (size_t i = 0; i < GROUP_WIDTH; ++i)
+            {
+                bits |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+            }
+            return bits;
+        }
+#endif
+    };
+
+    // 按组二次探测：第 i 次探测偏移 i*(i+1)/2 组，组数为 2 的幂时能遍历所有组
+    struct ProbeSeq
+    {
+        size_t mask;
+        size_t group;
+        size_t index = 0;
+        ProbeSeq(uint64_t hash, size_t capacity) : mask(capacity / GROUP_WIDTH - 1), group((hash >> 7) & mask) {}
+        size_t offset() const
+        {
+            return group * GROUP_WIDTH;
+        }
+        void next()
+        {
+            ++index;
+            group = (group + index) & mask;
+        }
+    };
+
+    size_t nextPowerOfTwo(size_t n)
+    {
+        size_t p = MIN_CAPACITY;
+        while (p < n)
+        {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    // 最大负载因子 7/8
+    size_t maxLoad(size_t capacity)
+    {
+        return capacity - capacity / 8;
+    }
+}
+
+template <typename Key>
+typename BasicIndexTable<Key>::Meta BasicIndexTable<Key>::decode(const Table &table, size_t pos)
+{
+    Meta meta{Traits::load(table.slots[pos].key), 0, 0, 0, false};
+    decodeLocation(table.slots[pos], meta);
+    meta.value = table.values.empty() ? nullptr : table.values[pos].get();
+    return meta;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::decodeLocation(const Slot &slot, Meta &meta)
+{
+    meta.deleted = slot.size == TOMBSTONE_SIZE;
+    meta.segment_id = static_cast<uint32_t>(slot.location >> 40);
+    meta.offset = static_cast<size_t>(slot.location & MAX_OFFSET);
+    meta.size = meta.deleted ? 0 : slot.size;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::encodeLocation(Slot &slot, const Meta &meta)
+{
+    assert(meta.segment_id <= MAX_SEGMENT_ID && meta.offset <= MAX_OFFSET && meta.size < TOMBSTONE_SIZE);
+    slot.size = meta.deleted ? TOMBSTONE_SIZE : static_cast<uint32_t>(meta.size);
+    slot.location = (static_cast<uint64_t>(meta.segment_id) << 40) | meta.offset;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::allocate(Table &table, size_t capacity) const
+{
+    table.capacity = capacity;
+    table.ctrl.assign(capacity, CTRL_EMPTY);
+    table.slots.assign(capacity, Slot{});
+    table.values.clear();
+    if (inline_values_)
+    {
+        table.values.resize(capacity);
+    }
+    table.size = 0;
+    table.deleted = 0;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::storeValue(Table &table, size_t pos, const Meta &meta)
+{
+    if (!inline_values_)
+    {
+        return;
+    }
+    std::unique_ptr<char[]> &value = table.values[pos];
+    if (value)
+    {
+        inline_bytes_ -= inlineCost(table.slots[pos].size == TOMBSTONE_SIZE ? 0 : table.slots[pos].size);
+        value.reset();
+    }
+    if (meta.value && !meta.deleted)
+    {
+        value.reset(new char[meta.size]);
+        std::memcpy(value.get(), meta.value, meta.size);
+        inline_bytes_ += inlineCost(meta.size);
+    }
+}
+
+template <typename Key>
+size_t BasicIndexTable<Key>::findSlot(const Table &table, const Key &key, uint64_t hash)
+{
+    if (table.size == 0)
+    {
+        return table.capacity;
+    }
+    int8_t tag = h2(hash);
+    for (ProbeSeq seq(hash, table.capacity);; seq.next())
+    {
+        Group group(&table.ctrl[seq.offset()]);
+        for (uint32_t bits = group.match(tag); bits != 0; bits &= bits - 1)
+        {
+            size_t pos = seq.offset() + __builtin_ctz(bits);
+            if (Traits::equals(table.slots[pos].key, key))
+            {
+                return pos;
+            }
+        }
+        // 组内有空槽说明探测链到此为止
+        if (group.matchEmpty() != 0 || seq.index == table.capacity / GROUP_WIDTH)
+        {
+            return table.capacity;
+        }
+    }
+}
+
+template <typename Key>
+size_t BasicIndexTable<Key>::insertNew(Table &table, Slot &&slot, uint64_t hash)
+{
+    for (ProbeSeq seq(hash, table.capacity);; seq.next())
+    {
+        uint32_t bits = Group(&table.ctrl[seq.offset()]).matchEmptyOrDeleted();
+        if (bits != 0)
+        {
+            size_t pos = seq.offset() + __builtin_ctz(bits);
+            if (table.ctrl[pos] == CTRL_DELETED)
+            {
+                table.deleted--;
+            }
+            table.ctrl[pos] = h2(hash);
+            table.slots[pos] = std::move(slot);
+            table.size++;
+            return pos;
+        }
+    }
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::moveSlot(Table &from, size_t pos, Table &to, uint64_t hash)
+{
+    size_t to_pos = insertNew(to, std::move(from.slots[pos]), hash);
+    if (!from.values.empty())
+    {
+        to.values[to_pos] = std::move(from.values[pos]);
+    }
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::eraseAt(Table &table, size_t pos)
+{
+    storeValue(table, pos, Meta{}); // 释放内联 value
+    table.slots[pos].key = typename Traits::Stored(); // 释放堆上的长 key
+
+    // 所在组仍有空槽时，经过该组的探测链本来就会在这里结束，可以直接置为 EMPTY
+    size_t group_start = pos & ~(GROUP_WIDTH - 1);
+    if (Group(&table.ctrl[group_start]).matchEmpty() != 0)
+    {
+        table.ctrl[pos] = CTRL_EMPTY;
+    }
+    else
+    {
+        table.ctrl[pos] = CTRL_DELETED;
+        table.deleted++;
+    }
+    table.size--;
+}
+
+template <typename Key>
+bool BasicIndexTable<Key>::find(const Key &key, Meta &meta) const
+{
+    uint64_t hash = Traits::hash(key);
+    const Table *table = &table_;
+    size_t pos = findSlot(table_, key, hash);
+    if (pos == table_.capacity)
+    {
+        table = &old_;
+        pos = findSlot(old_, key, hash);
+        if (pos == old_.capacity)
+        {
+            return false;
+        }
+    }
+    meta.key = key;
+    decodeLocation(table->slots[pos], meta);
+    meta.value = table->values.empty() ? nullptr : table->values[pos].get();
+    return true;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::insert(const Meta &meta)
+{
+    uint64_t hash = Traits::hash(meta.key);
+    size_t pos = findSlot(table_, meta.key, hash);
+    if (pos != table_.capacity)
+    {
+        storeValue(table_, pos, Meta{}); // 先按旧的 size 扣除占用
+        encodeLocation(table_.slots[pos], meta);
+        storeValue(table_, pos, meta);
+        return;
+    }
+
+    // 同一个 key 只存在于一张表中：旧表里的先删除，再插入新表
+    pos = findSlot(old_, meta.key, hash);
+    if (pos != old_.capacity)
+    {
+        eraseAt(old_, pos);
+    }
+    Slot slot;
+    slot.key = Traits::store(meta.key);
+    encodeLocation(slot, meta);
+    growIfNeeded();
+    pos = insertNew(table_, std::move(slot), hash);
+    storeValue(table_, pos, meta);
+    migrateStep();
+}
+
+template <typename Key>
+bool BasicIndexTable<Key>::relocate(const Meta &meta)
+{
+    uint64_t hash = Traits::hash(meta.key);
+    Table *table = &table_;
+    size_t pos = findSlot(table_, meta.key, hash);
+    if (pos == table_.capacity)
+    {
+        table = &old_;
+        pos = findSlot(old_, meta.key, hash);
+        if (pos == old_.capacity)
+        {
+            return false;
+        }
+    }
+    Slot &slot = table->slots[pos];
+    assert(meta.segment_id <= MAX_SEGMENT_ID && meta.offset <= MAX_OFFSET);
+    slot.location = (static_cast<uint64_t>(meta.segment_id) << 40) | meta.offset;
+    return true;
+}
+
+template <typename Key>
+bool BasicIndexTable<Key>::erase(const Key &key)
+{
+    uint64_t hash = Traits::hash(key);
+    size_t pos = findSlot(table_, key, hash);
+    if (pos != table_.capacity)
+    {
+        eraseAt(table_, pos);
+        migrateStep();
+        return true;
+    }
+    pos = findSlot(old_, key, hash);
+    if (pos != old_.capacity)
+    {
+        eraseAt(old_, pos);
+        migrateStep();
+        return true;
+    }
+    return false;
+}
+
+template <typename Key>
+size_t BasicIndexTable<Key>::size() const
+{
+    return table_.size + old_.size;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::reserve(size_t count)
+{
+    size_t capacity = nextPowerOfTwo(count + count / 7 + 1);
+    if (capacity <= table_.capacity)
+    {
+        return;
+    }
+    finishMigration();
+    Table old = std::move(table_);
+    allocate(table_, capacity);
+    for (size_t i = 0; i < old.capacity; ++i)
+    {
+        if (old.ctrl[i] >= 0)
+        {
+            moveSlot(old, i, table_, Traits::hashStored(old.slots[i].key));
+        }
+    }
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::clear()
+{
+    table_ = Table();
+    old_ = Table();
+    migrate_pos_ = 0;
+    inline_bytes_ = 0;
+}
+
+template <typename Key>
+size_t BasicIndexTable<Key>::memoryUsage() const
+{
+    size_t per_slot = sizeof(Slot) + sizeof(int8_t) + (inline_values_ ? sizeof(std::unique_ptr<char[]>) : 0);
+    return (table_.capacity + old_.capacity) * per_slot;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::enableInlineValues()
+{
+    if (inline_values_)
+    {
+        return;
+    }
+    inline_values_ = true;
+    table_.values.resize(table_.capacity);
+    old_.values.resize(old_.capacity);
+}
+
+template <typename Key>
+size_t BasicIndexTable<Key>::inlineBytes() const
+{
+    return inline_bytes_;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::growIfNeeded()
+{
+    if (table_.capacity == 0)
+    {
+        allocate(table_, MIN_CAPACITY);
+        return;
+    }
+    if (table_.size + table_.deleted + 1 <= maxLoad(table_.capacity))
+    {
+        return;
+    }
+
+    // 上一次扩容尚未迁移完时先完成它（每次修改迁移的量保证这几乎不会发生）
+    finishMigration();
+
+    // 有效项超过一半时翻倍，否则只是 DELETED 过多，以相同容量重建
+    size_t capacity = table_.size * 2 > table_.capacity ? table_.capacity * 2 : table_.capacity;
+    old_ = std::move(table_);
+    allocate(table_, capacity);
+    migrate_pos_ = 0;
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::migrateStep()
+{
+    if (old_.capacity == 0)
+    {
+        return;
+    }
+    size_t end = std::min(old_.capacity, migrate_pos_ + MIGRATE_BATCH);
+    for (; migrate_pos_ < end; ++migrate_pos_)
+    {
+        if (old_.ctrl[migrate_pos_] >= 0)
+        {
+            moveSlot(old_, migrate_pos_, table_, Traits::hashStored(old_.slots[migrate_pos_].key));
+            old_.ctrl[migrate_pos_] = CTRL_DELETED;
+            old_.size--;
+        }
+    }
+    if (migrate_pos_ == old_.capacity || old_.size == 0)
+    {
+        old_ = Table();
+        migrate_pos_ = 0;
+    }
+}
+
+template <typename Key>
+void BasicIndexTable<Key>::finishMigration()
+{
+    while (old_.capacity != 0)
+    {
+        migrateStep();
+    }
+}
+
+template class BasicIndexTable<int>;
+template class BasicIndexTable<std::string>;
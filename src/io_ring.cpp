@@ -0,0 +1,395 @@
+#include "io_ring.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+    int ioUringSetup(unsigned entries, io_uring_params *params)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    int ioUringRegister(int fd, unsigned opcode, void *arg, unsigned nr_args)
+    {
+        return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+    }
+
+    // 用于唤醒完成线程退出的 NOP 请求标记
+    const uint64_t WAKEUP_USER_DATA = 0;
+
+    // 查询内核是否支持用到的操作码。5.1–5.5 的内核能创建 io_uring，但不支持 IORING_OP_READ/WRITE，
+    // 提交后每个请求都以 -EINVAL 完成；这些内核也不支持 IORING_REGISTER_PROBE，查询失败即视为不支持
+    bool supportsOpcodes(int ring_fd)
+    {
+        const unsigned probe_ops = 256;
+        std::vector<char> storage(sizeof(io_uring_probe) + probe_ops * sizeof(io_uring_probe_op), 0);
+        auto *probe = reinterpret_cast<io_uring_probe *>(storage.data());
+        if (ioUringRegister(ring_fd, IORING_REGISTER_PROBE, probe, probe_ops) < 0)
+        {
+            return false;
+        }
+        for (uint8_t opcode : {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC})
+        {
+            if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+IoRing::IoRing(unsigned entries)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    ring_fd_ = ioUringSetup(entries, &params);
+    if (ring_fd_ < 0)
+    {
+        return;
+    }
+    if (!supportsOpcodes(ring_fd_))
+    {
+        std::cerr << "io_uring does not support positioned read/write, falling back to synchronous I/O." << std::endl;
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+        return;
+    }
+    entries_ = params.sq_entries;
+    cq_entries_ = params.cq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+    sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        std::cerr << "Failed to map io_uring queues, falling back to synchronous I/O." << std::endl;
+        sq_ring_ = sq_ring_ == MAP_FAILED ? nullptr : sq_ring_;
+        cq_ring_ = cq_ring_ == MAP_FAILED ? nullptr : cq_ring_;
+        if (sqes != MAP_FAILED)
+        {
+            ::munmap(sqes, sqes_size_);
+        }
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+        return;
+    }
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    char *sq = static_cast<char *>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+    char *cq = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    completion_thread_ = std::thread(&IoRing::reap, this);
+}
+
+IoRing::~IoRing()
+{
+    if (completion_thread_.joinable())
+    {
+        // 等待在途请求完成后，提交一个 NOP 唤醒完成线程退出
+        {
+            std::unique_lock<std::mutex> lock(submit_mtx_);
+            space_cv_.wait(lock, [this]
+                           { return inflight_ == 0; });
+        }
+        stop_ = true;
+        Request wakeup{IORING_OP_NOP, -1, 0, 0, 0, 0, nullptr};
+        submit(&wakeup, 1);
+        completion_thread_.join();
+    }
+
+    if (sqes_)
+    {
+        ::munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_)
+    {
+        ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_)
+    {
+        ::munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0)
+    {
+        ::close(ring_fd_);
+    }
+}
+
+bool IoRing::available() const
+{
+    return ring_fd_ >= 0 && completion_thread_.joinable() && !failed_;
+}
+
+bool IoRing::read(int fd, char *buf, size_t size, uint64_t offset, Completion completion)
+{
+    return submitWithCompletion(IORING_OP_READ, fd, reinterpret_cast<uint64_t>(buf), size, offset, std::move(completion));
+}
+
+bool IoRing::write(int fd, const char *buf, size_t size, uint64_t offset, Completion completion)
+{
+    return submitWithCompletion(IORING_OP_WRITE, fd, reinterpret_cast<uint64_t>(buf), size, offset, std::move(completion));
+}
+
+bool IoRing::fdatasync(int fd, Completion completion)
+{
+    return submitWithCompletion(IORING_OP_FSYNC, fd, 0, 0, 0, std::move(completion), IORING_FSYNC_DATASYNC);
+}
+
+// SQE 的长度字段只有 32 位，更大的读写交给调用者的同步路径
+bool IoRing::submitWithCompletion(uint8_t opcode, int fd, uint64_t addr, size_t size, uint64_t offset, Completion completion, uint32_t op_flags)
+{
+    if (!available() || size > UINT32_MAX)
+    {
+        return false;
+    }
+    auto *heap_completion = new Completion(std::move(completion));
+    Request request{opcode, fd, addr, static_cast<uint32_t>(size), offset, op_flags, heap_completion};
+    if (!submit(&request, 1))
+    {
+        delete heap_completion;
+        return false;
+    }
+    return true;
+}
+
+bool IoRing::writeLinked(const std::vector<LinkedWrite> &writes, Completion completion)
+{
+    if (!available() || writes.empty())
+    {
+        return false;
+    }
+
+    // 每个请求各有一个回调，记下第一个失败的结果，最后一个结束的回调转交汇总结果
+    struct Chain
+    {
+        std::atomic<size_t> remaining;
+        std::atomic<int> result{0};
+        Completion completion;
+    };
+    auto chain = std::make_shared<Chain>();
+    chain->remaining = writes.size();
+    chain->completion = std::move(completion);
+
+    std::vector<Request> requests;
+    requests.reserve(writes.size());
+    for (const LinkedWrite &write : writes)
+    {
+        if (write.size > UINT32_MAX)
+        {
+            for (const Request &request : requests)
+            {
+                delete request.completion;
+            }
+            return false;
+        }
+        bool sync = write.buf == nullptr;
+        size_t expected = sync ? 0 : write.size;
+        auto *step = new Completion([chain, expected](int res)
+                                    {
+            int error = res < 0 ? res : (static_cast<size_t>(res) != expected ? -EIO : 0);
+            int none = 0;
+            if (error != 0) {
+                chain->result.compare_exchange_strong(none, error);
+            }
+            if (--chain->remaining == 0) {
+                chain->completion(chain->result);
+            } });
+        requests.push_back(Request{static_cast<uint8_t>(sync ? IORING_OP_FSYNC : IORING_OP_WRITE), write.fd,
+                                   reinterpret_cast<uint64_t>(write.buf), static_cast<uint32_t>(write.size),
+                                   sync ? 0 : write.offset, sync ? IORING_FSYNC_DATASYNC : 0u, step});
+    }
+    if (!submit(requests.data(), static_cast<unsigned>(requests.size()), true))
+    {
+        for (const Request &request : requests)
+        {
+            delete request.completion;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool IoRing::submit(const Request *requests, unsigned count, bool linked)
+{
+    std::unique_lock<std::mutex> lock(submit_mtx_);
+    if (failed_)
+    {
+        return false;
+    }
+
+    // 在途请求不超过完成队列深度，完成队列因此不会溢出。其他线程以提交队列深度为上限，
+    // 完成线程自身不能等待名额（名额只由它释放），在剩余的余量内提交，超出时直接返回 false
+    bool wakeup = requests[0].completion == nullptr;
+    if (!wakeup)
+    {
+        if (std::this_thread::get_id() == completion_thread_.get_id())
+        {
+            if (inflight_ + count > cq_entries_)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (count > entries_)
+            {
+                return false;
+            }
+            space_cv_.wait(lock, [this, count]
+                           { return failed_ || inflight_ + count <= entries_; });
+            if (failed_)
+            {
+                return false;
+            }
+        }
+        inflight_ += count;
+    }
+
+    unsigned tail = *sq_tail_;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        const Request &request = requests[i];
+        unsigned index = (tail + i) & *sq_mask_;
+        io_uring_sqe *sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = request.opcode;
+        sqe->fd = request.fd;
+        sqe->addr = request.addr;
+        sqe->len = request.size;
+        sqe->off = request.offset;
+        sqe->fsync_flags = request.op_flags;
+        sqe->flags = linked && i + 1 < count ? IOSQE_IO_LINK : 0;
+        sqe->user_data = wakeup ? WAKEUP_USER_DATA : reinterpret_cast<uint64_t>(request.completion);
+        sq_array_[index] = index;
+    }
+    __atomic_store_n(sq_tail_, tail + count, __ATOMIC_RELEASE);
+
+    int ret;
+    do
+    {
+        ret = ioUringEnter(ring_fd_, count, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+
+    // 内核只在取走 SQE 前出错时返回负值，此时一个都没有取走
+    unsigned consumed = ret > 0 ? static_cast<unsigned>(ret) : 0;
+    if (consumed < count)
+    {
+        // 回退未被取走的 SQE；链中已取走的部分照常完成，其余请求的回调以 -ECANCELED 执行
+        __atomic_store_n(sq_tail_, tail + consumed, __ATOMIC_RELEASE);
+        if (!wakeup)
+        {
+            inflight_ -= count - consumed;
+        }
+        if (consumed == 0)
+        {
+            return false;
+        }
+        for (unsigned i = 0; i < consumed; ++i)
+        {
+            pending_.insert(requests[i].completion);
+        }
+        lock.unlock();
+        space_cv_.notify_all();
+        for (unsigned i = consumed; i < count; ++i)
+        {
+            (*requests[i].completion)(-ECANCELED);
+            delete requests[i].completion;
+        }
+        return true;
+    }
+    if (!wakeup)
+    {
+        for (unsigned i = 0; i < count; ++i)
+        {
+            pending_.insert(requests[i].completion);
+        }
+    }
+    return true;
+}
+
+void IoRing::reap()
+{
+    while (true)
+    {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        if (head == tail)
+        {
+            if (stop_)
+            {
+                return;
+            }
+            // EBUSY 表示完成队列有溢出的事件，继续取出即可
+            int ret = ioUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+            if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                std::cerr << "io_uring_enter failed: " << std::strerror(errno) << std::endl;
+                failPending();
+                return;
+            }
+            continue;
+        }
+
+        io_uring_cqe cqe = cqes_[head & *cq_mask_];
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+
+        if (cqe.user_data == WAKEUP_USER_DATA)
+        {
+            continue;
+        }
+
+        // 先释放在途名额再执行回调：回调中可能继续提交新的请求
+        Completion *completion = reinterpret_cast<Completion *>(cqe.user_data);
+        {
+            std::lock_guard<std::mutex> lock(submit_mtx_);
+            inflight_--;
+            pending_.erase(completion);
+        }
+        space_cv_.notify_all();
+
+        (*completion)(cqe.res);
+        delete completion;
+    }
+}
+
+// 内核仍可能在之后访问这些请求的缓冲区，回调对象（及其持有的缓冲区）因此不释放
+void IoRing::failPending()
+{
+    std::unordered_set<Completion *> pending;
+    {
+        std::lock_guard<std::mutex> lock(submit_mtx_);
+        failed_ = true;
+        pending.swap(pending_);
+        inflight_ = 0;
+    }
+    space_cv_.notify_all();
+    for (Completion *completion : pending)
+    {
+        (*completion)(-EIO);
+    }
+}
@@ -0,0 +1,124 @@
+#include "key_traits.h"
+#include <utility>
+
+namespace
+{
+    const uint64_t HASH_P0 = 0xa0761d6478bd642fULL;
+    const uint64_t HASH_P1 = 0xe7037ed1a0b428dbULL;
+    const uint64_t HASH_P2 = 0x8ebc6af09c88c6e3ULL;
+
+    // 128 位乘积的高低两半异或
+    uint64_t mulFold(uint64_t a, uint64_t b)
+    {
+        __uint128_t r = static_cast<__uint128_t>(a) * b;
+        return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+    }
+
+    uint64_t load64(const char *p)
+    {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    uint64_t load32(const char *p)
+    {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+}
+
+uint64_t hashBytes(const char *data, size_t size, uint64_t seed)
+{
+    uint64_t h = seed ^ HASH_P0 ^ size;
+    const char *p = data;
+    size_t remaining = size;
+    while (remaining > 16)
+    {
+        h = mulFold(load64(p) ^ HASH_P1, load64(p + 8) ^ h);
+        p += 16;
+        remaining -= 16;
+    }
+
+    // 剩余 0~16 字节：首尾两次读取可以重叠，不需要逐字节处理
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (remaining >= 8)
+    {
+        a = load64(p);
+        b = load64(p + remaining - 8);
+    }
+    else if (remaining >= 4)
+    {
+        a = load32(p);
+        b = load32(p + remaining - 4);
+    }
+    else if (remaining > 0)
+    {
+        a = (static_cast<uint64_t>(static_cast<uint8_t>(p[0])) << 16) |
+            (static_cast<uint64_t>(static_cast<uint8_t>(p[remaining / 2])) << 8) |
+            static_cast<uint8_t>(p[remaining - 1]);
+    }
+    return mulFold(mulFold(a ^ HASH_P1, b ^ h) ^ HASH_P2, size ^ HASH_P1);
+}
+
+SmallKey::SmallKey(std::string_view key) : size_(static_cast<uint32_t>(key.size()))
+{
+    if (isInline())
+    {
+        std::memcpy(bytes_, key.data(), key.size());
+    }
+    else
+    {
+        char *p = new char[key.size()];
+        std::memcpy(p, key.data(), key.size());
+        std::memcpy(bytes_, &p, sizeof(p));
+    }
+}
+
+SmallKey::SmallKey(const SmallKey &other) : SmallKey(other.view())
+{
+}
+
+SmallKey::SmallKey(SmallKey &&other) noexcept : size_(other.size_)
+{
+    std::memcpy(bytes_, other.bytes_, INLINE_CAPACITY);
+    other.size_ = 0; // 堆上的 key 转移所有权
+}
+
+SmallKey &SmallKey::operator=(const SmallKey &other)
+{
+    if (this != &other)
+    {
+        SmallKey copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+SmallKey &SmallKey::operator=(SmallKey &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        size_ = other.size_;
+        std::memcpy(bytes_, other.bytes_, INLINE_CAPACITY);
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+SmallKey::~SmallKey()
+{
+    release();
+}
+
+void SmallKey::release()
+{
+    if (!isInline())
+    {
+        delete[] heapPointer();
+    }
+    size_ = 0;
+}
@@ -0,0 +1,125 @@
+#include "ordered_index.h"
+#include <algorithm>
+#include <iterator>
+
+template <typename Key>
+typename BasicOrderedKeyIndex<Key>::LeafIterator BasicOrderedKeyIndex<Key>::findLeaf(const Key &key)
+{
+    auto it = leaves_.upper_bound(key);
+    if (it != leaves_.begin())
+    {
+        --it;
+    }
+    return it;
+}
+
+template <typename Key>
+void BasicOrderedKeyIndex<Key>::rekey(LeafIterator &it)
+{
+    auto node = leaves_.extract(it);
+    node.key() = node.mapped().front();
+    it = leaves_.insert(std::move(node)).position;
+}
+
+template <typename Key>
+void BasicOrderedKeyIndex<Key>::insert(const Key &key)
+{
+    if (leaves_.empty())
+    {
+        leaves_.emplace(key, std::vector<Key>{key});
+        size_ = 1;
+        return;
+    }
+
+    auto it = findLeaf(key);
+    std::vector<Key> &leaf = it->second;
+    auto pos = std::lower_bound(leaf.begin(), leaf.end(), key);
+    if (pos != leaf.end() && *pos == key)
+    {
+        return;
+    }
+    leaf.insert(pos, key);
+    size_++;
+    if (leaf.front() == key && it->first != key)
+    {
+        rekey(it); // 比所有 key 都小，插入到了第一个叶子的头部
+    }
+
+    // 叶子写满后对半分裂
+    if (it->second.size() > LEAF_CAPACITY)
+    {
+        std::vector<Key> &full = it->second;
+        size_t half = full.size() / 2;
+        std::vector<Key> upper(std::make_move_iterator(full.begin() + half), std::make_move_iterator(full.end()));
+        full.resize(half);
+        Key first = upper.front();
+        leaves_.emplace(first, std::move(upper));
+    }
+}
+
+template <typename Key>
+void BasicOrderedKeyIndex<Key>::erase(const Key &key)
+{
+    if (leaves_.empty())
+    {
+        return;
+    }
+    auto it = findLeaf(key);
+    std::vector<Key> &leaf = it->second;
+    auto pos = std::lower_bound(leaf.begin(), leaf.end(), key);
+    if (pos == leaf.end() || *pos != key)
+    {
+        return;
+    }
+    leaf.erase(pos);
+    size_--;
+
+    if (leaf.empty())
+    {
+        leaves_.erase(it);
+        return;
+    }
+    if (it->first != leaf.front())
+    {
+        rekey(it);
+    }
+
+    // 叶子过空时并入后一个叶子，避免大量删除后留下许多几乎为空的叶子
+    auto next = std::next(it);
+    if (it->second.size() < LEAF_CAPACITY / 4 && next != leaves_.end() &&
+        it->second.size() + next->second.size() <= LEAF_CAPACITY)
+    {
+        it->second.insert(it->second.end(), std::make_move_iterator(next->second.begin()), std::make_move_iterator(next->second.end()));
+        leaves_.erase(next);
+    }
+}
+
+template <typename Key>
+void BasicOrderedKeyIndex<Key>::assign(const std::vector<Key> &sorted_keys)
+{
+    // 叶子填到 3/4，给后续插入留出余量
+    leaves_.clear();
+    const size_t fill = LEAF_CAPACITY * 3 / 4;
+    for (size_t i = 0; i < sorted_keys.size(); i += fill)
+    {
+        size_t end = std::min(sorted_keys.size(), i + fill);
+        leaves_.emplace_hint(leaves_.end(), sorted_keys[i], std::vector<Key>(sorted_keys.begin() + i, sorted_keys.begin() + end));
+    }
+    size_ = sorted_keys.size();
+}
+
+template <typename Key>
+void BasicOrderedKeyIndex<Key>::clear()
+{
+    leaves_.clear();
+    size_ = 0;
+}
+
+template <typename Key>
+size_t BasicOrderedKeyIndex<Key>::size() const
+{
+    return size_;
+}
+
+template class BasicOrderedKeyIndex<int>;
+template class BasicOrderedKeyIndex<std::string>;
@@ -0,0 +1,365 @@
+#include "record.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+    std::array<uint32_t, 256> makeCrcTable()
+    {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return table;
+    }
+
+    const std::array<uint32_t, 256> CRC_TABLE = makeCrcTable();
+
+    template <typename T>
+    void putField(char *&p, T v)
+    {
+        std::memcpy(p, &v, sizeof(T));
+        p += sizeof(T);
+    }
+
+    template <typename T>
+    T getField(const char *&p)
+    {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    // LEB128 变长整数：每字节 7 位，最高位表示后面还有字节
+    void appendVarint(std::string &out, uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            out.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    bool readVarint(const char *&p, const char *end, uint64_t &v)
+    {
+        v = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7)
+        {
+            uint8_t byte = static_cast<uint8_t>(*p++);
+            v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+uint32_t crc32(const char *data, size_t size, uint32_t crc)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = CRC_TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void appendRecord(std::string &out, const char *key, size_t key_size, const char *value, size_t value_size, uint64_t seq, uint8_t flags)
+{
+    size_t start = out.size();
+    size_t total = recordSize(value_size, key_size);
+    out.resize(start + total);
+
+    char *p = &out[start] + sizeof(uint32_t); // checksum 最后回填
+    putField<uint64_t>(p, seq);
+    putField<uint32_t>(p, static_cast<uint32_t>(key_size));
+    putField<uint32_t>(p, static_cast<uint32_t>(value_size));
+    putField<uint8_t>(p, flags);
+    putField<uint8_t>(p, 0);
+    putField<uint16_t>(p, 0);
+    std::memcpy(p, key, key_size);
+    p += key_size;
+    if (value_size > 0)
+    {
+        std::memcpy(p, value, value_size);
+    }
+
+    char *record = &out[start];
+    uint32_t checksum = crc32(record + sizeof(uint32_t), total - sizeof(uint32_t));
+    std::memcpy(record, &checksum, sizeof(checksum));
+}
+
+size_t beginBatchRecord(std::string &out)
+{
+    size_t start = out.size();
+    out.resize(start + RECORD_HEADER_SIZE);
+    return start;
+}
+
+void finishBatchRecord(std::string &out, size_t frame_start, uint64_t seq)
+{
+    size_t total = out.size() - frame_start;
+    char *p = &out[frame_start] + sizeof(uint32_t);
+    putField<uint64_t>(p, seq);
+    putField<uint32_t>(p, 0);
+    putField<uint32_t>(p, static_cast<uint32_t>(total - RECORD_HEADER_SIZE));
+    putField<uint8_t>(p, RECORD_FLAG_BATCH);
+    putField<uint8_t>(p, 0);
+    putField<uint16_t>(p, 0);
+
+    char *frame = &out[frame_start];
+    uint32_t checksum = crc32(frame + sizeof(uint32_t), total - sizeof(uint32_t));
+    std::memcpy(frame, &checksum, sizeof(checksum));
+}
+
+int parseRecord(const char *data, size_t available, RecordHeader &header)
+{
+    if (available < RECORD_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    const char *p = data;
+    header.checksum = getField<uint32_t>(p);
+    header.seq = getField<uint64_t>(p);
+    header.key_size = getField<uint32_t>(p);
+    header.value_size = getField<uint32_t>(p);
+    header.flags = getField<uint8_t>(p);
+
+    if (header.key_size > RECORD_MAX_KEY_SIZE)
+    {
+        return -1;
+    }
+    size_t total = recordSize(header.value_size, header.key_size);
+    if (available < total)
+    {
+        return 0;
+    }
+    if (crc32(data + sizeof(uint32_t), total - sizeof(uint32_t)) != header.checksum)
+    {
+        return -1;
+    }
+    return 1;
+}
+
+void encodeFileHeader(char *out, uint64_t segment_id)
+{
+    putField<uint32_t>(out, DATA_FILE_MAGIC);
+    putField<uint32_t>(out, DATA_FILE_VERSION);
+    putField<uint64_t>(out, segment_id);
+}
+
+bool decodeFileHeader(const char *data, uint64_t &segment_id)
+{
+    uint32_t magic = getField<uint32_t>(data);
+    uint32_t version = getField<uint32_t>(data);
+    segment_id = getField<uint64_t>(data);
+    return magic == DATA_FILE_MAGIC && version == DATA_FILE_VERSION;
+}
+
+void encodeIndexHeader(char *out, const IndexFileHeader &header, uint32_t version)
+{
+    putField<uint32_t>(out, INDEX_FILE_MAGIC);
+    putField<uint32_t>(out, version);
+    putField<uint64_t>(out, header.entry_count);
+    putField<uint64_t>(out, header.active_segment);
+    putField<uint64_t>(out, header.log_end);
+    putField<uint64_t>(out, header.next_segment_id);
+    putField<uint64_t>(out, header.next_seq);
+    putField<uint64_t>(out, header.blob_segment);
+    putField<uint64_t>(out, header.blob_log_end);
+}
+
+bool decodeIndexHeader(const char *data, size_t file_size, IndexFileHeader &header, uint32_t version)
+{
+    if (file_size < INDEX_FILE_HEADER_SIZE + INDEX_FILE_TRAILER_SIZE)
+    {
+        return false;
+    }
+    uint32_t magic = getField<uint32_t>(data);
+    uint32_t file_version = getField<uint32_t>(data);
+    header.entry_count = getField<uint64_t>(data);
+    header.active_segment = getField<uint64_t>(data);
+    header.log_end = getField<uint64_t>(data);
+    header.next_segment_id = getField<uint64_t>(data);
+    header.next_seq = getField<uint64_t>(data);
+    header.blob_segment = getField<uint64_t>(data);
+    header.blob_log_end = getField<uint64_t>(data);
+    if (magic != INDEX_FILE_MAGIC || file_version != version)
+    {
+        return false;
+    }
+    size_t body = file_size - INDEX_FILE_HEADER_SIZE - INDEX_FILE_TRAILER_SIZE;
+    return version != INDEX_FILE_VERSION || (body % INDEX_ENTRY_SIZE == 0 && header.entry_count == body / INDEX_ENTRY_SIZE);
+}
+
+void encodeIndexEntry(char *out, const IndexEntry &entry)
+{
+    putField<int32_t>(out, entry.key);
+    putField<uint32_t>(out, entry.segment_id);
+    putField<uint64_t>(out, entry.offset);
+    putField<uint32_t>(out, entry.value_size);
+    putField<uint8_t>(out, entry.flags);
+}
+
+void decodeIndexEntry(const char *data, IndexEntry &entry)
+{
+    entry.key = getField<int32_t>(data);
+    entry.segment_id = getField<uint32_t>(data);
+    entry.offset = getField<uint64_t>(data);
+    entry.value_size = getField<uint32_t>(data);
+    entry.flags = getField<uint8_t>(data);
+}
+
+bool decodeIndexEntry(const char *&p, const char *end, IndexEntry &entry)
+{
+    if (static_cast<size_t>(end - p) < INDEX_ENTRY_SIZE)
+    {
+        return false;
+    }
+    decodeIndexEntry(p, entry);
+    p += INDEX_ENTRY_SIZE;
+    return true;
+}
+
+void appendIndexEntry(std::string &out, const BasicIndexEntry<std::string> &entry, const std::string &prev_key)
+{
+    size_t limit = std::min(prev_key.size(), entry.key.size());
+    size_t shared = 0;
+    while (shared < limit && prev_key[shared] == entry.key[shared])
+    {
+        shared++;
+    }
+    appendVarint(out, shared);
+    appendVarint(out, entry.key.size() - shared);
+    out.append(entry.key, shared, std::string::npos);
+
+    size_t start = out.size();
+    out.resize(start + INDEX_ENTRY_SIZE - RECORD_KEY_SIZE);
+    char *p = &out[start];
+    putField<uint32_t>(p, entry.segment_id);
+    putField<uint64_t>(p, entry.offset);
+    putField<uint32_t>(p, entry.value_size);
+    putField<uint8_t>(p, entry.flags);
+}
+
+bool decodeIndexEntry(const char *&p, const char *end, BasicIndexEntry<std::string> &entry)
+{
+    uint64_t shared;
+    uint64_t suffix;
+    if (!readVarint(p, end, shared) || !readVarint(p, end, suffix) || shared > entry.key.size() ||
+        static_cast<uint64_t>(end - p) < suffix + INDEX_ENTRY_SIZE - RECORD_KEY_SIZE)
+    {
+        return false;
+    }
+    entry.key.resize(shared);
+    entry.key.append(p, suffix);
+    p += suffix;
+    entry.segment_id = getField<uint32_t>(p);
+    entry.offset = getField<uint64_t>(p);
+    entry.value_size = getField<uint32_t>(p);
+    entry.flags = getField<uint8_t>(p);
+    return true;
+}
+
+void encodeHintHeader(char *out, const HintFileHeader &header, uint32_t version)
+{
+    putField<uint32_t>(out, HINT_FILE_MAGIC);
+    putField<uint32_t>(out, version);
+    putField<uint64_t>(out, header.segment_id);
+    putField<uint64_t>(out, header.data_end);
+    putField<uint64_t>(out, header.min_seq);
+    putField<uint64_t>(out, header.entry_count);
+}
+
+bool decodeHintHeader(const char *data, size_t file_size, HintFileHeader &header, uint32_t version)
+{
+    if (file_size < HINT_FILE_HEADER_SIZE + HINT_FILE_TRAILER_SIZE)
+    {
+        return false;
+    }
+    uint32_t magic = getField<uint32_t>(data);
+    uint32_t file_version = getField<uint32_t>(data);
+    header.segment_id = getField<uint64_t>(data);
+    header.data_end = getField<uint64_t>(data);
+    header.min_seq = getField<uint64_t>(data);
+    header.entry_count = getField<uint64_t>(data);
+    if (magic != HINT_FILE_MAGIC || file_version != version)
+    {
+        return false;
+    }
+    size_t body = file_size - HINT_FILE_HEADER_SIZE - HINT_FILE_TRAILER_SIZE;
+    return version != HINT_FILE_VERSION || (body % HINT_ENTRY_SIZE == 0 && header.entry_count == body / HINT_ENTRY_SIZE);
+}
+
+void appendHintEntry(std::string &out, const HintEntry &entry)
+{
+    size_t start = out.size();
+    out.resize(start + HINT_ENTRY_SIZE);
+    char *p = &out[start];
+    putField<int32_t>(p, entry.key);
+    putField<uint64_t>(p, entry.offset);
+    putField<uint32_t>(p, entry.value_size);
+    putField<uint64_t>(p, entry.seq);
+    putField<uint8_t>(p, entry.flags);
+}
+
+bool decodeHintEntry(const char *&p, const char *end, HintEntry &entry)
+{
+    if (static_cast<size_t>(end - p) < HINT_ENTRY_SIZE)
+    {
+        return false;
+    }
+    entry.key = getField<int32_t>(p);
+    entry.offset = getField<uint64_t>(p);
+    entry.value_size = getField<uint32_t>(p);
+    entry.seq = getField<uint64_t>(p);
+    entry.flags = getField<uint8_t>(p);
+    return true;
+}
+
+void appendHintEntry(std::string &out, const BasicHintEntry<std::string> &entry)
+{
+    size_t start = out.size();
+    out.resize(start + sizeof(uint16_t) + entry.key.size() + HINT_ENTRY_SIZE - RECORD_KEY_SIZE);
+    char *p = &out[start];
+    putField<uint16_t>(p, static_cast<uint16_t>(entry.key.size()));
+    std::memcpy(p, entry.key.data(), entry.key.size());
+    p += entry.key.size();
+    putField<uint64_t>(p, entry.offset);
+    putField<uint32_t>(p, entry.value_size);
+    putField<uint64_t>(p, entry.seq);
+    putField<uint8_t>(p, entry.flags);
+}
+
+bool decodeHintEntry(const char *&p, const char *end, BasicHintEntry<std::string> &entry)
+{
+    const size_t fixed = HINT_ENTRY_SIZE - RECORD_KEY_SIZE;
+    if (static_cast<size_t>(end - p) < sizeof(uint16_t))
+    {
+        return false;
+    }
+    size_t key_size = getField<uint16_t>(p);
+    if (static_cast<size_t>(end - p) < key_size + fixed)
+    {
+        return false;
+    }
+    entry.key.assign(p, key_size);
+    p += key_size;
+    entry.offset = getField<uint64_t>(p);
+    entry.value_size = getField<uint32_t>(p);
+    entry.seq = getField<uint64_t>(p);
+    entry.flags = getField<uint8_t>(p);
+    return true;
+}
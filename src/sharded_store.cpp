@@ -0,0 +1,514 @@
+#include "sharded_store.h"
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cctype>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+// 记录分片数的文件：<storage_file>.shards
+#define SHARDS_FILE_SUFFIX ".shards"
+
+namespace
+{
+    // 分片数为 1 时沿用原来的文件路径，否则每个分片使用 <file_path>.shard<i> 作为段文件前缀
+    std::string shardPath(const std::string &file_path, size_t shard_count, size_t index)
+    {
+        return shard_count == 1 ? file_path : file_path + ".shard" + std::to_string(index);
+    }
+
+    // 没有分片数文件时，<file_path> 下已有的检查点或段文件（<file_path>.<id>）说明这是一个未分片的存储
+    bool hasUnshardedData(const std::string &file_path)
+    {
+        namespace fs = std::filesystem;
+        fs::path base(file_path);
+        fs::path dir = base.parent_path().empty() ? fs::path(".") : base.parent_path();
+        std::string prefix = base.filename().string() + ".";
+        std::error_code ec;
+        for (const auto &entry : fs::directory_iterator(dir, ec))
+        {
+            std::string name = entry.path().filename().string();
+            if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+                (std::isdigit(static_cast<unsigned char>(name[prefix.size()])) || name == prefix + "idx"))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 先写临时文件并同步，再原子替换并同步目录，崩溃时要么没有分片数文件，要么是完整的
+    bool saveShardCount(const std::string &path, size_t shard_count)
+    {
+        std::string data = std::to_string(shard_count) + "\n";
+        std::string temp_path = path + ".tmp";
+        int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool ok = fd >= 0 && ::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()) && ::fsync(fd) == 0;
+        if (fd >= 0 && ::close(fd) != 0)
+        {
+            ok = false;
+        }
+        if (!ok || std::rename(temp_path.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        std::filesystem::path dir = std::filesystem::path(path).parent_path();
+        int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir_fd >= 0)
+        {
+            ::fsync(dir_fd);
+            ::close(dir_fd);
+        }
+        return true;
+    }
+
+    // 32 位整数混合（murmur3 finalizer），连续的 key 也能均匀分散到各分片。
+    // 与分片内索引表使用的哈希不同，同一分片内的 key 在索引表中仍然均匀分布
+    uint32_t shardHash(int key)
+    {
+        uint32_t h = static_cast<uint32_t>(key);
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // 字节串 key 使用带独立种子的 hashBytes，理由同上
+    const uint64_t SHARD_HASH_SEED = 0x5348415244ULL;
+
+    uint64_t shardHash(const std::string &key)
+    {
+        return hashBytes(key.data(), key.size(), SHARD_HASH_SEED);
+    }
+}
+
+template <typename Key>
+BasicShardedFileStore<Key>::BasicShardedFileStore(const std::string &file_path, size_t shard_count, bool clean_start, const FileStoreOptions &options)
+{
+    if (shard_count == 0)
+    {
+        shard_count = 1;
+    }
+
+    // 分片数在创建时写入一次，此后以文件中的为准；没有该文件但已有未分片的数据时按 1 个分片打开
+    std::string shards_file_path = file_path + SHARDS_FILE_SUFFIX;
+    size_t stored = 0;
+    if (clean_start)
+    {
+        std::remove(shards_file_path.c_str());
+    }
+    else
+    {
+        std::ifstream shards_file(shards_file_path);
+        if (!(shards_file >> stored) && hasUnshardedData(file_path))
+        {
+            stored = 1;
+        }
+        if (stored > 0 && stored != shard_count)
+        {
+            std::cerr << "Store was created with " << stored << " shards, ignoring requested " << shard_count << "." << std::endl;
+            shard_count = stored;
+        }
+    }
+    if (!std::filesystem::exists(shards_file_path) && !saveShardCount(shards_file_path, shard_count))
+    {
+        std::cerr << "Failed to save shard count to file!" << std::endl;
+    }
+
+    // 内联 value 的预算由各分片平分
+    FileStoreOptions shard_options = options;
+    shard_options.inline_value_budget = options.inline_value_budget / shard_count;
+    shards_.reserve(shard_count);
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        shards_.push_back(std::make_unique<Store>(shardPath(file_path, shard_count, i), clean_start, shard_options));
+    }
+}
+
+template <typename Key>
+size_t BasicShardedFileStore<Key>::shardFor(const Key &key) const
+{
+    return shards_.size() == 1 ? 0 : shardHash(key) % shards_.size();
+}
+
+template <typename Key>
+bool BasicShardedFileStore<Key>::put(const Key &key, const std::string &value)
+{
+    return shards_[shardFor(key)]->put(key, value);
+}
+
+template <typename Key>
+std::string BasicShardedFileStore<Key>::get(const Key &key)
+{
+    return shards_[shardFor(key)]->get(key);
+}
+
+template <typename Key>
+bool BasicShardedFileStore<Key>::del(const Key &key)
+{
+    return shards_[shardFor(key)]->del(key);
+}
+
+template <typename Key>
+void BasicShardedFileStore<Key>::asyncGet(const Key &key, std::function<void(std::string)> callback)
+{
+    shards_[shardFor(key)]->asyncGet(key, std::move(callback));
+}
+
+template <typename Key>
+void BasicShardedFileStore<Key>::asyncPut(const Key &key, const std::string &value, std::function<void(bool)> callback)
+{
+    shards_[shardFor(key)]->asyncPut(key, value, std::move(callback));
+}
+
+template <typename Key>
+void BasicShardedFileStore<Key>::asyncDel(const Key &key, std::function<void(bool)> callback)
+{
+    shards_[shardFor(key)]->asyncDel(key, std::move(callback));
+}
+
+template <typename Key>
+std::vector<std::string> BasicShardedFileStore<Key>::multiGet(std::span<const Key> keys)
+{
+    if (shards_.size() == 1)
+    {
+        return shards_[0]->multiGet(keys);
+    }
+    std::vector<std::vector<Key>> shard_keys(shards_.size());
+    std::vector<std::vector<size_t>> slots(shards_.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        size_t index = shardFor(keys[i]);
+        shard_keys[index].push_back(keys[i]);
+        slots[index].push_back(i);
+    }
+    std::vector<std::string> values(keys.size());
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        if (shard_keys[s].empty())
+        {
+            continue;
+        }
+        std::vector<std::string> part = shards_[s]->multiGet(shard_keys[s]);
+        for (size_t j = 0; j < part.size(); ++j)
+        {
+            values[slots[s][j]] = std::move(part[j]);
+        }
+    }
+    return values;
+}
+
+template <typename Key>
+void BasicShardedFileStore<Key>::asyncMultiGet(std::span<const Key> keys, std::function<void(std::vector<std::string>)> callback)
+{
+    if (shards_.size() == 1)
+    {
+        shards_[0]->asyncMultiGet(keys, std::move(callback));
+        return;
+    }
+
+    // 各分片的回调可能在不同的完成线程上执行，最后一个完成的分片回调
+    struct State
+    {
+        std::vector<std::vector<size_t>> slots;
+        std::vector<std::string> values;
+        std::atomic<size_t> remaining{0};
+        std::function<void(std::vector<std::string>)> callback;
+    };
+    auto state = std::make_shared<State>();
+    state->slots.resize(shards_.size());
+    state->values.resize(keys.size());
+    state->callback = std::move(callback);
+    std::vector<std::vector<Key>> shard_keys(shards_.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        size_t index = shardFor(keys[i]);
+        shard_keys[index].push_back(keys[i]);
+        state->slots[index].push_back(i);
+    }
+    size_t used = std::count_if(shard_keys.begin(), shard_keys.end(), [](const std::vector<Key> &part)
+                                { return !part.empty(); });
+    if (used == 0)
+    {
+        state->callback(std::move(state->values));
+        return;
+    }
+    state->remaining = used;
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        if (shard_keys[s].empty())
+        {
+            continue;
+        }
+        shards_[s]->asyncMultiGet(shard_keys[s], [state, s](std::vector<std::string> part)
+                                  {
+            for (size_t j = 0; j < part.size(); ++j) {
+                state->values[state->slots[s][j]] = std::move(part[j]);
+            }
+            if (--state->remaining == 0) {
+                state->callback(std::move(state->values));
+            } });
+    }
+}
+
+template <typename Key>
+bool BasicShardedFileStore<Key>::multiPut(std::span<const std::pair<Key, std::string>> items)
+{
+    if (shards_.size() == 1)
+    {
+        return shards_[0]->multiPut(items);
+    }
+    std::vector<std::vector<std::pair<Key, std::string>>> parts(shards_.size());
+    for (const auto &item : items)
+    {
+        parts[shardFor(item.first)].push_back(item);
+    }
+    bool ok = true;
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        if (!parts[s].empty())
+        {
+            ok = shards_[s]->multiPut(parts[s]) && ok;
+        }
+    }
+    return ok;
+}
+
+template <typename Key>
+void BasicShardedFileStore<Key>::asyncMultiPut(std::span<const std::pair<Key, std::string>> items, std::function<void(bool)> callback)
+{
+    if (shards_.size() == 1)
+    {
+        shards_[0]->asyncMultiPut(items, std::move(callback));
+        return;
+    }
+
+    struct State
+    {
+        std::atomic<size_t> remaining{0};
+        std::atomic<bool> success{true};
+        std::function<void(bool)> callback;
+    };
+    auto state = std::make_shared<State>();
+    state->callback = std::move(callback);
+    std::vector<std::vector<std::pair<Key, std::string>>> parts(shards_.size());
+    for (const auto &item : items)
+    {
+        parts[shardFor(item.first)].push_back(item);
+    }
+    size_t used = std::count_if(parts.begin(), parts.end(), [](const auto &part)
+                                { return !part.empty(); });
+    if (used == 0)
+    {
+        state->callback(true);
+        return;
+    }
+    state->remaining = used;
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        if (parts[s].empty())
+        {
+            continue;
+        }
+        shards_[s]->asyncMultiPut(parts[s], [state](bool success)
+                                  {
+            if (!success) {
+                state->success = false;
+            }
+            if (--state->remaining == 0) {
+                state->callback(state->success);
+            } });
+    }
+}
+
+template <typename Key>
+std::vector<BasicWriteBatch<Key>> BasicShardedFileStore<Key>::splitBatch(const BasicWriteBatch<Key> &batch) const
+{
+    std::vector<BasicWriteBatch<Key>> parts(shards_.size());
+    for (const auto &op : batch.operations())
+    {
+        BasicWriteBatch<Key> &part = parts[shardFor(op.key)];
+        if (op.tombstone)
+        {
+            part.del(op.key);
+        }
+        else
+        {
+            part.put(op.key, op.value);
+        }
+    }
+    return parts;
+}
+
+template <typename Key>
+bool BasicShardedFileStore<Key>::write(const BasicWriteBatch<Key> &batch)
+{
+    if (shards_.size() == 1)
+    {
+        return shards_[0]->write(batch);
+    }
+    std::vector<BasicWriteBatch<Key>> parts = splitBatch(batch);
+    bool ok = true;
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        if (!parts[s].empty())
+        {
+            ok = shards_[s]->write(parts[s]) && ok;
+        }
+    }
+    return ok;
+}
+
+template <typename Key>
+void BasicShardedFileStore<Key>::asyncWrite(const BasicWriteBatch<Key> &batch, std::function<void(bool)> callback)
+{
+    if (shards_.size() == 1)
+    {
+        shards_[0]->asyncWrite(batch, std::move(callback));
+        return;
+    }
+
+    struct State
+    {
+        std::atomic<size_t> remaining{0};
+        std::atomic<bool> success{true};
+        std::function<void(bool)> callback;
+    };
+    auto state = std::make_shared<State>();
+    state->callback = std::move(callback);
+    std::vector<BasicWriteBatch<Key>> parts = splitBatch(batch);
+    size_t used = std::count_if(parts.begin(), parts.end(), [](const BasicWriteBatch<Key> &part)
+                                { return !part.empty(); });
+    if (used == 0)
+    {
+        state->callback(true);
+        return;
+    }
+    state->remaining = used;
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        if (parts[s].empty())
+        {
+            continue;
+        }
+        shards_[s]->asyncWrite(parts[s], [state](bool success)
+                               {
+            if (!success) {
+                state->success = false;
+            }
+            if (--state->remaining == 0) {
+                state->callback(state->success);
+            } });
+    }
+}
+
+template <typename Key>
+bool BasicShardedFileStore<Key>::hasAsyncIo() const
+{
+    for (const auto &shard : shards_)
+    {
+        if (!shard->hasAsyncIo())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Key>
+std::vector<BasicScanEntry<Key>> BasicShardedFileStore<Key>::scan(const Key &start, const Key &end, size_t limit)
+{
+    if (shards_.size() == 1)
+    {
+        return shards_[0]->scan(start, end, limit);
+    }
+    // key 按哈希分布在所有分片上：每个分片各取前 limit 个，合并后再截断
+    std::vector<ScanEntry> merged;
+    for (const auto &shard : shards_)
+    {
+        std::vector<ScanEntry> part = shard->scan(start, end, limit);
+        merged.insert(merged.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    }
+    std::sort(merged.begin(), merged.end(), [](const ScanEntry &a, const ScanEntry &b)
+              { return a.key < b.key; });
+    if (merged.size() > limit)
+    {
+        merged.resize(limit);
+    }
+    return merged;
+}
+
+template <typename Key>
+bool BasicShardedFileStore<Key>::sync()
+{
+    bool ok = true;
+    for (const auto &shard : shards_)
+    {
+        ok = shard->sync() && ok;
+    }
+    return ok;
+}
+
+template <typename Key>
+size_t BasicShardedFileStore<Key>::getSyncCount() const
+{
+    size_t total = 0;
+    for (const auto &shard : shards_)
+    {
+        total += shard->getSyncCount();
+    }
+    return total;
+}
+
+template <typename Key>
+size_t BasicShardedFileStore<Key>::getReadCount() const
+{
+    size_t total = 0;
+    for (const auto &shard : shards_)
+    {
+        total += shard->getReadCount();
+    }
+    return total;
+}
+
+template <typename Key>
+size_t BasicShardedFileStore<Key>::getCommitBatchCount() const
+{
+    size_t total = 0;
+    for (const auto &shard : shards_)
+    {
+        total += shard->getCommitBatchCount();
+    }
+    return total;
+}
+
+template <typename Key>
+size_t BasicShardedFileStore<Key>::garbageCollect()
+{
+    size_t reclaimed = 0;
+    for (const auto &shard : shards_)
+    {
+        reclaimed += shard->garbageCollect();
+    }
+    return reclaimed;
+}
+
+template <typename Key>
+size_t BasicShardedFileStore<Key>::shardCount() const
+{
+    return shards_.size();
+}
+
+template <typename Key>
+typename BasicShardedFileStore<Key>::Store &BasicShardedFileStore<Key>::shard(size_t index)
+{
+    return *shards_[index];
+}
+
+template class BasicShardedFileStore<int>;
+template class BasicShardedFileStore<std::string>;
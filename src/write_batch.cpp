@@ -0,0 +1,48 @@
+#include "write_batch.h"
+
+template <typename Key>
+void BasicWriteBatch<Key>::put(const Key &key, const std::string &value)
+{
+    operations_.push_back(Operation{key, value, false});
+    value_bytes_ += value.size();
+}
+
+template <typename Key>
+void BasicWriteBatch<Key>::del(const Key &key)
+{
+    operations_.push_back(Operation{key, std::string(), true});
+}
+
+template <typename Key>
+void BasicWriteBatch<Key>::clear()
+{
+    operations_.clear();
+    value_bytes_ = 0;
+}
+
+template <typename Key>
+size_t BasicWriteBatch<Key>::count() const
+{
+    return operations_.size();
+}
+
+template <typename Key>
+bool BasicWriteBatch<Key>::empty() const
+{
+    return operations_.empty();
+}
+
+template <typename Key>
+size_t BasicWriteBatch<Key>::valueBytes() const
+{
+    return value_bytes_;
+}
+
+template <typename Key>
+const std::vector<typename BasicWriteBatch<Key>::Operation> &BasicWriteBatch<Key>::operations() const
+{
+    return operations_;
+}
+
+template class BasicWriteBatch<int>;
+template class BasicWriteBatch<std::string>;
@@ -0,0 +1,328 @@
+#include <gtest/gtest.h>
+#include "cache.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// 基本的读写删除，以及字节串 key
+TEST(CacheTest, PutGetRemove)
+{
+    BasicClockCache<std::string> cache(16, 2);
+    std::string value;
+    EXPECT_FALSE(cache.get("a", value));
+    cache.put("a", "1");
+    cache.put("b", "2");
+    ASSERT_TRUE(cache.get("a", value));
+    EXPECT_EQ(value, "1");
+    cache.put("a", "3");
+    ASSERT_TRUE(cache.get("a", value));
+    EXPECT_EQ(value, "3");
+    cache.remove("a");
+    EXPECT_FALSE(cache.get("a", value));
+    ASSERT_TRUE(cache.get("b", value));
+    EXPECT_EQ(value, "2");
+}
+
+// 二次机会：持续被访问的项不会被淘汰，只访问一次的项被后来的项替换
+TEST(CacheTest, ClockKeepsReferencedEntries)
+{
+    const int capacity = 64;
+    ClockCache cache(capacity, 1);
+    std::string value;
+    for (int key = 0; key < 1000; ++key)
+    {
+        cache.get(0, value); // 热点项在指针每次经过前都被再次访问
+        cache.put(key + 1, "v" + std::to_string(key + 1));
+        if (key == 0)
+        {
+            cache.put(0, "hot");
+        }
+    }
+    ASSERT_TRUE(cache.get(0, value));
+    EXPECT_EQ(value, "hot");
+
+    // 容量之内的最近插入项仍在缓存中，更早的已被淘汰
+    int cached = 0;
+    for (int key = 1; key <= 1000; ++key)
+    {
+        cached += cache.get(key, value) ? 1 : 0;
+    }
+    EXPECT_EQ(cached, capacity - 1);
+    EXPECT_TRUE(cache.get(1000, value));
+    EXPECT_FALSE(cache.get(1, value));
+
+    // 删除后腾出的槽被直接复用，不淘汰其他项
+    cache.remove(1000);
+    cache.put(5000, "new");
+    ASSERT_TRUE(cache.get(0, value));
+    EXPECT_TRUE(cache.get(999, value));
+    EXPECT_TRUE(cache.get(5000, value));
+}
+
+// 按字节计费：大小不一的 value 共享同一预算，占用始终不超过预算
+TEST(CacheTest, ByteBudget)
+{
+    const size_t budget = 64 * 1024;
+    CacheOptions options;
+    options.capacity_bytes = budget;
+    BasicClockCache<std::string> cache(0, 4, options);
+
+    std::string value;
+    for (int i = 0; i < 2000; ++i)
+    {
+        size_t size = (i % 10 == 0) ? 4000 : 10;
+        cache.put("key" + std::to_string(i), std::string(size, 'x'));
+        ASSERT_LE(cache.memoryUsage(), budget);
+    }
+    EXPECT_GT(cache.memoryUsage(), budget / 2);
+
+    size_t entries = 0;
+    for (const auto &stats : cache.getSegmentStats())
+    {
+        EXPECT_LE(stats.bytes, stats.budget);
+        EXPECT_EQ(stats.budget, budget / 4);
+        entries += stats.entries;
+    }
+    EXPECT_GT(entries, 50u);
+
+    // 超过段预算的 value 不缓存，更新为大 value 时旧项也被移除
+    cache.put("key1", std::string(budget, 'y'));
+    EXPECT_FALSE(cache.get("key1", value));
+    cache.put("huge", std::string(budget, 'y'));
+    EXPECT_FALSE(cache.get("huge", value));
+
+    // 删除后计费归零
+    for (int i = 0; i < 2000; ++i)
+    {
+        cache.remove("key" + std::to_string(i));
+    }
+    EXPECT_EQ(cache.memoryUsage(), 0u);
+}
+
+// 预算调整：命中集中的段获得更多预算，总预算不变
+TEST(CacheTest, RebalanceFavorsHotSegments)
+{
+    const size_t budget = 256 * 1024;
+    CacheOptions options;
+    options.capacity_bytes = budget;
+    options.rebalance_interval = 64;
+    ClockCache cache(0, 4, options);
+
+    std::string value;
+    for (int key = 0; key < 16; ++key)
+    {
+        cache.put(key, std::string(100, 'h'));
+    }
+    // 只反复读取一个热点 key，随后的写入触发调整
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_TRUE(cache.get(3, value));
+    }
+    for (int key = 100; key < 164; ++key)
+    {
+        cache.put(key, std::string(100, 'c'));
+    }
+
+    auto stats = cache.getSegmentStats();
+    size_t total_budget = 0;
+    size_t max_budget = 0;
+    for (const auto &segment : stats)
+    {
+        total_budget += segment.budget;
+        max_budget = std::max(max_budget, segment.budget);
+        EXPECT_GE(segment.budget, budget / 4 / 2);
+        EXPECT_LE(segment.bytes, segment.budget);
+    }
+    EXPECT_LE(total_budget, budget);
+    EXPECT_GT(max_budget, budget / 4 * 3 / 2);
+    EXPECT_TRUE(cache.get(3, value));
+}
+
+// W-TinyLFU 准入：一次性的顺序扫描不会换出反复访问的热点项
+TEST(CacheTest, AdmissionResistsScans)
+{
+    const int capacity = 1000;
+    CacheOptions options;
+    options.admission = true;
+    options.window_ratio = 0.05;
+    ClockCache cache(capacity, 1, options);
+
+    std::string value;
+    auto access = [&cache, &value](int key)
+    {
+        if (!cache.get(key, value))
+        {
+            cache.put(key, "v" + std::to_string(key));
+        }
+    };
+    for (int round = 0; round < 5; ++round)
+    {
+        for (int key = 0; key < 500; ++key)
+        {
+            access(key);
+        }
+    }
+    // 扫描期间热点项仍在被访问
+    for (int key = 100000; key < 120000; ++key)
+    {
+        access(key);
+        access(key % 500);
+    }
+
+    int hot_cached = 0;
+    for (int key = 0; key < 500; ++key)
+    {
+        hot_cached += cache.get(key, value) ? 1 : 0;
+    }
+    EXPECT_EQ(hot_cached, 500);
+
+    auto stats = cache.getSegmentStats();
+    EXPECT_LE(stats[0].entries, static_cast<size_t>(capacity));
+    EXPECT_LE(stats[0].window_entries, static_cast<size_t>(capacity * 0.05));
+    EXPECT_GT(stats[0].rejected, 0u);
+
+    // 没有准入时同样的扫描会冲刷掉热点项
+    ClockCache plain(capacity, 1);
+    for (int round = 0; round < 5; ++round)
+    {
+        for (int key = 0; key < 500; ++key)
+        {
+            if (!plain.get(key, value))
+            {
+                plain.put(key, "v");
+            }
+        }
+    }
+    for (int key = 100000; key < 102000; ++key)
+    {
+        plain.put(key, "v");
+    }
+    EXPECT_FALSE(plain.get(0, value));
+}
+
+// 开启准入时按字节计费的上限、更新与删除仍然成立
+TEST(CacheTest, AdmissionWithByteBudget)
+{
+    const size_t budget = 32 * 1024;
+    CacheOptions options;
+    options.capacity_bytes = budget;
+    options.admission = true;
+    options.window_ratio = 0.1;
+    BasicClockCache<std::string> cache(0, 2, options);
+
+    std::string value;
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string key = "key" + std::to_string(i % 700);
+        if (!cache.get(key, value))
+        {
+            cache.put(key, std::string(i % 7 == 0 ? 1000 : 20, 'x'));
+        }
+        ASSERT_LE(cache.memoryUsage(), budget);
+    }
+    cache.put("fresh", "new");
+    cache.put("fresh", "newer");
+    ASSERT_TRUE(cache.get("fresh", value));
+    EXPECT_EQ(value, "newer");
+    cache.remove("fresh");
+    EXPECT_FALSE(cache.get("fresh", value));
+    for (int i = 0; i < 700; ++i)
+    {
+        cache.remove("key" + std::to_string(i));
+    }
+    EXPECT_EQ(cache.memoryUsage(), 0u);
+    for (const auto &stats : cache.getSegmentStats())
+    {
+        EXPECT_EQ(stats.entries, 0u);
+        EXPECT_EQ(stats.window_entries, 0u);
+    }
+}
+
+// 段数组：段按缓存行对齐，段数取 2 的幂，自动段数不会让每段过小
+TEST(CacheTest, SegmentLayoutAndCount)
+{
+    EXPECT_EQ(alignof(BasicClockCacheSegment<int>), CACHE_LINE_SIZE);
+    EXPECT_EQ(sizeof(BasicClockCacheSegment<std::string>) % CACHE_LINE_SIZE, 0u);
+
+    EXPECT_EQ(ClockCache(100, 3).getSegmentStats().size(), 4u);
+    EXPECT_EQ(ClockCache(100, 1).getSegmentStats().size(), 1u);
+
+    size_t automatic = ClockCache(1000000, 0).getSegmentStats().size();
+    EXPECT_GE(automatic, 2u);
+    EXPECT_EQ(automatic & (automatic - 1), 0u);
+    EXPECT_EQ(ClockCache(20, 0).getSegmentStats().size(), 1u);
+
+    CacheOptions options;
+    options.capacity_bytes = 128 * 1024;
+    EXPECT_LE(ClockCache(0, 0, options).getSegmentStats().size(), 2u);
+}
+
+// 按步长递增的 key 也均匀分布到各段
+TEST(CacheTest, StridedKeysSpreadAcrossSegments)
+{
+    const size_t segments = 16;
+    for (int stride : {1, 16, 1024, 65536})
+    {
+        ClockCache cache(0, segments);
+        for (int i = 0; i < 16000; ++i)
+        {
+            cache.put(i * stride, "v");
+        }
+        for (const auto &stats : cache.getSegmentStats())
+        {
+            EXPECT_GT(stats.entries, 800u) << "stride " << stride;
+            EXPECT_LT(stats.entries, 1200u) << "stride " << stride;
+        }
+    }
+}
+
+// 并发命中与写入：读者不加锁，更新、删除与淘汰期间始终读到完整的值
+TEST(CacheTest, ConcurrentHits)
+{
+    ClockCache cache(256, 4);
+    for (int key = 0; key < 128; ++key)
+    {
+        cache.put(key, std::string(64, static_cast<char>('a' + key % 26)));
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+        readers.emplace_back([&cache, &stop, &torn]()
+                             {
+            std::string value;
+            for (int i = 0; !stop; i = (i + 1) % 128) {
+                if (cache.get(i, value) && value != std::string(64, static_cast<char>('a' + i % 26)) &&
+                    value != std::string(64, 'z')) {
+                    torn++;
+                }
+            } });
+    }
+    for (int round = 0; round < 200; ++round)
+    {
+        for (int key = 0; key < 128; ++key)
+        {
+            cache.put(key, round % 2 ? std::string(64, 'z') : std::string(64, static_cast<char>('a' + key % 26)));
+        }
+        cache.put(1000 + round, "extra"); // 触发淘汰
+        cache.remove(1000 + round);
+    }
+    stop = true;
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(torn.load(), 0);
+
+    // 只有写入计入所在段的锁获取次数，读取不获取锁；争用次数不超过获取次数
+    size_t acquisitions = 0;
+    for (const auto &stats : cache.getSegmentStats())
+    {
+        EXPECT_LE(stats.lock_contended, stats.lock_acquisitions);
+        acquisitions += stats.lock_acquisitions;
+    }
+    EXPECT_EQ(acquisitions, 128u + 200u * 130u);
+}
@@ -1,12 +1,12 @@
 #include <gtest/gtest.h>
 #include "engine.h"
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <thread>
 #include <filesystem>
 
 static const std::string TEST_DB_FILE = "data/test_db.dat";
-static const std::string TEST_DB_IDX_FILE = "data/test_db.dat.idx";
 
 class EngineTest : public ::testing::Test
 {
@@ -14,26 +14,30 @@ protected:
     void SetUp() override
     {
         // 清理测试用文件
-        if (std::filesystem::exists(TEST_DB_FILE))
-        {
-            std::filesystem::remove(TEST_DB_FILE);
-        }
-        if (std::filesystem::exists(TEST_DB_IDX_FILE))
-        {
-            std::filesystem::remove(TEST_DB_IDX_FILE);
-        }
+        cleanup();
     }
 
     void TearDown() override
     {
         // 测试结束后清理
-        if (std::filesystem::exists(TEST_DB_FILE))
+        cleanup();
+    }
+
+    // 删除数据段文件、索引文件等所有以 TEST_DB_FILE 为前缀的文件
+    void cleanup()
+    {
+        std::filesystem::path dir = std::filesystem::path(TEST_DB_FILE).parent_path();
+        std::string prefix = std::filesystem::path(TEST_DB_FILE).filename().string();
+        if (!std::filesystem::exists(dir))
         {
-            std::filesystem::remove(TEST_DB_FILE);
+            return;
         }
-        if (std::filesystem::exists(TEST_DB_IDX_FILE))
+        for (const auto &entry : std::filesystem::directory_iterator(dir))
         {
-            std::filesystem::remove(TEST_DB_IDX_FILE);
+            if (entry.path().filename().string().rfind(prefix, 0) == 0)
+            {
+                std::filesystem::remove(entry.path());
+            }
         }
     }
 };
@@ -92,8 +96,8 @@ TEST_F(EngineTest, CacheHit)
     EXPECT_EQ(reads_after_first_get, reads_after_second_get);
 }
 
-// LRU缓存淘汰行为测试
-TEST_F(EngineTest, LRUBehavior)
+// CLOCK缓存淘汰行为测试：被访问过的项获得第二次机会，未被访问的项先被淘汰
+TEST_F(EngineTest, ClockBehavior)
 {
     StorageEngine engine(TEST_DB_FILE, 4, 3, 1); // 线程池大小4，缓存容量3，缓存段数1
 
@@ -101,7 +105,7 @@ TEST_F(EngineTest, LRUBehavior)
     size_t initial_reads = engine.getFileStoreReadCount();
     EXPECT_EQ(initial_reads, 0);
 
-    // 插入3个键值对
+    // 插入3个键值对，依次占用槽 0、1、2，访问标记均为 0
     engine.put(1, "value1");
     engine.put(2, "value2");
     engine.put(3, "value3");
@@ -109,40 +113,26 @@ TEST_F(EngineTest, LRUBehavior)
     // 这三个put操作应将数据写入缓存，不应触发FileStore::get
     EXPECT_EQ(engine.getFileStoreReadCount(), initial_reads);
 
-    // 获取所有3个键，应该命中缓存，不触发FileStore::get {3,2,1}
+    // 访问键1，置位其访问标记
     EXPECT_EQ(engine.get(1), "value1");
-    EXPECT_EQ(engine.get(2), "value2");
-    EXPECT_EQ(engine.get(3), "value3");
-
-    // 读取计数应保持不变
     EXPECT_EQ(engine.getFileStoreReadCount(), initial_reads);
 
-    // 访问键1，使其成为最近使用 {1,3,2}
-    EXPECT_EQ(engine.get(1), "value1");
-
-    // 读取计数仍应保持不变
-    EXPECT_EQ(engine.getFileStoreReadCount(), initial_reads);
-
-    // 插入第4个键，缓存容量为3，应淘汰最久未使用的键2 {4,1,3}
+    // 插入第4个键：指针经过键1时清零其标记，淘汰未被访问的键2，指针停在键3
     engine.put(4, "value4");
 
-    // 获取键2，应触发FileStore::get，因为键2被淘汰 {2,4,1}
+    // 获取键2，应触发FileStore::get；回填缓存时淘汰指针处未被访问的键3
     EXPECT_EQ(engine.get(2), "value2");
-
-    // 读取计数应增加1
     EXPECT_EQ(engine.getFileStoreReadCount(), initial_reads + 1);
 
     // 再次获取键2，应命中缓存，不触发FileStore::get
     EXPECT_EQ(engine.get(2), "value2");
-
-    // 读取计数应保持不变
     EXPECT_EQ(engine.getFileStoreReadCount(), initial_reads + 1);
 
-    // 获取键3和键4，键4应命中缓存，键3应触发FileStore::get {3,2,4}
-    EXPECT_EQ(engine.get(3), "value3");
+    // 键1与键4仍在缓存中，键3已被淘汰
+    EXPECT_EQ(engine.get(1), "value1");
     EXPECT_EQ(engine.get(4), "value4");
-
-    // 读取计数应增加1
+    EXPECT_EQ(engine.getFileStoreReadCount(), initial_reads + 1);
+    EXPECT_EQ(engine.get(3), "value3");
     EXPECT_EQ(engine.getFileStoreReadCount(), initial_reads + 2);
 }
 
@@ -191,6 +181,79 @@ TEST_F(EngineTest, AsyncOperations)
     EXPECT_TRUE(final_val.empty());
 }
 
+// 异步回调中可以再调用同步接口：回调在线程池上执行，不占用存储的完成线程与提交令牌
+TEST_F(EngineTest, NestedCallsInAsyncCallbacks)
+{
+    StorageEngine engine(TEST_DB_FILE, 4, 100, 8);
+
+    std::atomic<int> done{0};
+    engine.asyncPut(20, "outer", [&engine, &done](bool res)
+                    {
+        EXPECT_TRUE(res);
+        EXPECT_TRUE(engine.put(21, "nested"));
+        done++; });
+    engine.asyncGet(20, [&engine, &done](std::string)
+                    {
+        EXPECT_TRUE(engine.put(22, "nested_from_get"));
+        done++; });
+    engine.asyncDel(20, [&engine, &done](bool)
+                    {
+        EXPECT_TRUE(engine.put(23, "nested_from_del"));
+        done++; });
+
+    for (int i = 0; i < 500 && done.load() < 3; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(done.load(), 3);
+    EXPECT_EQ(engine.get(21), "nested");
+    EXPECT_EQ(engine.get(22), "nested_from_get");
+    EXPECT_EQ(engine.get(23), "nested_from_del");
+}
+
+// 共享读取：命中返回缓存中的同一个缓冲区，更新与删除不影响已返回的句柄
+TEST_F(EngineTest, SharedGet)
+{
+    StorageEngine engine(TEST_DB_FILE, 4, 100, 8);
+    EXPECT_EQ(engine.getShared(1), nullptr);
+
+    engine.put(1, std::string(32 * 1024, 'a'));
+    SharedValue first = engine.getShared(1);
+    SharedValue second = engine.getShared(1);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first.get(), second.get()); // 命中不复制
+    EXPECT_EQ(*first, std::string(32 * 1024, 'a'));
+    EXPECT_EQ(engine.getFileStoreReadCount(), 0u);
+
+    engine.put(1, "b");
+    engine.del(1);
+    EXPECT_EQ(*first, std::string(32 * 1024, 'a'));
+    EXPECT_EQ(engine.getShared(1), nullptr);
+
+    // 未命中时从存储读取，放入缓存的与返回的是同一个缓冲区
+    {
+        StorageEngine reopened(TEST_DB_FILE + ".shared", 4, 100, 8);
+        reopened.put(2, "two");
+    }
+    StorageEngine reopened(TEST_DB_FILE + ".shared", 4, 100, 8);
+    SharedValue loaded = reopened.getShared(2);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(*loaded, "two");
+    EXPECT_EQ(reopened.getFileStoreReadCount(), 1u);
+    EXPECT_EQ(reopened.getShared(2).get(), loaded.get());
+    EXPECT_EQ(reopened.getFileStoreReadCount(), 1u);
+
+    std::atomic<bool> done{false};
+    reopened.asyncGetShared(2, [&done, &loaded](SharedValue value)
+                            {
+        EXPECT_EQ(value.get(), loaded.get());
+        done = true; });
+    while (!done.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
 // 测试GC逻辑
 TEST_F(EngineTest, GarbageCollectTest)
 {
@@ -264,3 +327,197 @@ TEST_F(EngineTest, ConcurrentAccess)
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
+
+// 分片存储：同步与异步接口在多个分片上行为一致
+TEST_F(EngineTest, ShardedStorage)
+{
+    const int N = 1000;
+    {
+        StorageEngine engine(TEST_DB_FILE, 4, 100, 8, 4);
+        std::atomic<int> completed{0};
+        for (int i = 0; i < N; ++i)
+        {
+            engine.asyncPut(i, "sharded_" + std::to_string(i), [&completed](bool res)
+                            {
+                EXPECT_TRUE(res);
+                completed++; });
+        }
+        while (completed.load() < N)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        for (int i = 0; i < N; i += 2)
+        {
+            EXPECT_TRUE(engine.del(i));
+        }
+        engine.garbageCollect();
+    }
+
+    StorageEngine reopened(TEST_DB_FILE, 4, 100, 8, 4);
+    for (int i = 0; i < N; ++i)
+    {
+        EXPECT_EQ(reopened.get(i), i % 2 == 0 ? "" : "sharded_" + std::to_string(i));
+    }
+}
+
+TEST_F(EngineTest, RangeScanAcrossShards)
+{
+    FileStoreOptions options;
+    options.ordered_index = true;
+    StorageEngine engine(TEST_DB_FILE, 4, 100, 8, 4, options);
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(engine.put(i, "scan_" + std::to_string(i)));
+    }
+    EXPECT_TRUE(engine.del(150));
+
+    // 分页遍历 [100, 300)
+    std::vector<int> keys;
+    int start = 100;
+    while (true)
+    {
+        std::vector<ScanEntry> page = engine.scan(start, 300, 64);
+        for (const auto &entry : page)
+        {
+            EXPECT_EQ(entry.value, "scan_" + std::to_string(entry.key));
+            keys.push_back(entry.key);
+        }
+        if (page.size() < 64)
+        {
+            break;
+        }
+        start = page.back().key + 1;
+    }
+    ASSERT_EQ(keys.size(), 199u);
+    for (size_t i = 1; i < keys.size(); ++i)
+    {
+        EXPECT_LT(keys[i - 1], keys[i]);
+    }
+    EXPECT_EQ(std::count(keys.begin(), keys.end(), 150), 0);
+}
+
+// 字节串 key 的引擎：缓存、分片路由与分页扫描
+TEST_F(EngineTest, StringKeys)
+{
+    FileStoreOptions options;
+    options.ordered_index = true;
+    StringStorageEngine engine(TEST_DB_FILE, 4, 100, 8, 4, options);
+    for (int i = 0; i < 500; ++i)
+    {
+        EXPECT_TRUE(engine.put("order/" + std::to_string(i), "value_" + std::to_string(i)));
+    }
+    EXPECT_EQ(engine.get("order/42"), "value_42");
+    EXPECT_EQ(engine.get("order/42"), "value_42"); // 缓存命中
+    EXPECT_TRUE(engine.del("order/42"));
+    EXPECT_EQ(engine.get("order/42"), "");
+
+    // "order/4" 开头的 key 共 111 个，删除一个后剩 110 个
+    std::vector<std::string> keys;
+    std::string start = "order/4";
+    while (true)
+    {
+        std::vector<BasicScanEntry<std::string>> page = engine.scan(start, "order/5", 32);
+        for (const auto &entry : page)
+        {
+            EXPECT_EQ(entry.value, "value_" + entry.key.substr(6));
+            keys.push_back(entry.key);
+        }
+        if (page.size() < 32)
+        {
+            break;
+        }
+        start = page.back().key + '\0';
+    }
+    ASSERT_EQ(keys.size(), 110u);
+    EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+}
+
+// 批量接口：缓存命中与未命中混合、跨分片拆分，异步版本整批只回调一次
+TEST_F(EngineTest, MultiGetAndMultiPut)
+{
+    StorageEngine engine(TEST_DB_FILE, 4, 100, 8, 4);
+    std::vector<std::pair<int, std::string>> items;
+    for (int i = 0; i < 300; ++i)
+    {
+        items.emplace_back(i, "multi_" + std::to_string(i));
+    }
+    ASSERT_TRUE(engine.multiPut(items));
+    EXPECT_TRUE(engine.del(10));
+
+    std::vector<int> keys = {299, 0, 10, 1000, 150, 0};
+    std::vector<std::string> expected = {"multi_299", "multi_0", "", "", "multi_150", "multi_0"};
+    EXPECT_EQ(engine.multiGet(keys), expected);
+    EXPECT_EQ(engine.multiGet(keys), expected); // 第二次全部由缓存提供
+
+    std::vector<std::pair<int, std::string>> more = {{500, "a"}, {501, "b"}, {0, "overwritten"}};
+    std::atomic<bool> put_done{false};
+    engine.asyncMultiPut(more, [&put_done](bool res)
+                         {
+        EXPECT_TRUE(res);
+        put_done = true; });
+    while (!put_done.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::atomic<bool> get_done{false};
+    std::vector<std::string> values;
+    engine.asyncMultiGet(std::vector<int>{501, 0, 10, 500}, [&](std::vector<std::string> result)
+                         {
+        values = std::move(result);
+        get_done = true; });
+    while (!get_done.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(values, (std::vector<std::string>{"b", "overwritten", "", "a"}));
+}
+
+// 原子批次：写入后缓存中的旧值失效；批次帧经过压缩与提示文件重建后仍能正确恢复
+TEST_F(EngineTest, WriteBatch)
+{
+    FileStoreOptions options;
+    options.segment_size = 4096;
+    {
+        StorageEngine engine(TEST_DB_FILE, 4, 100, 8, 1, options);
+        EXPECT_TRUE(engine.put(1, "cached"));
+        EXPECT_EQ(engine.get(1), "cached");
+
+        for (int round = 0; round < 20; ++round)
+        {
+            WriteBatch batch;
+            for (int i = 0; i < 20; ++i)
+            {
+                batch.put(i, "round_" + std::to_string(round) + "_" + std::to_string(i));
+            }
+            batch.del(19);
+            EXPECT_TRUE(engine.write(batch));
+        }
+        EXPECT_EQ(engine.get(1), "round_19_1");
+        EXPECT_EQ(engine.get(19), "");
+
+        std::atomic<bool> done{false};
+        WriteBatch async_batch;
+        async_batch.put(100, "async");
+        async_batch.del(0);
+        engine.asyncWrite(async_batch, [&done](bool ok)
+                          {
+            EXPECT_TRUE(ok);
+            done = true; });
+        while (!done.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        engine.garbageCollect();
+    }
+
+    std::filesystem::remove(TEST_DB_FILE + ".idx");
+    StorageEngine reopened(TEST_DB_FILE, 4, 100, 8, 1, options);
+    EXPECT_EQ(reopened.get(0), "");
+    for (int i = 1; i < 19; ++i)
+    {
+        EXPECT_EQ(reopened.get(i), "round_19_" + std::to_string(i));
+    }
+    EXPECT_EQ(reopened.get(19), "");
+    EXPECT_EQ(reopened.get(100), "async");
+}
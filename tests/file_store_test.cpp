@@ -0,0 +1,1329 @@
+#include <gtest/gtest.h>
+#include "file_store.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+static const std::string TEST_STORE_FILE = "data/test_file_store.dat";
+
+class FileStoreTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        cleanup();
+    }
+
+    void TearDown() override
+    {
+        cleanup();
+    }
+
+    // 删除数据文件及其所有附属文件
+    void cleanup()
+    {
+        std::filesystem::path dir = std::filesystem::path(TEST_STORE_FILE).parent_path();
+        std::string prefix = std::filesystem::path(TEST_STORE_FILE).filename().string();
+        if (!std::filesystem::exists(dir))
+        {
+            return;
+        }
+        for (const auto &entry : std::filesystem::directory_iterator(dir))
+        {
+            if (entry.path().filename().string().rfind(prefix, 0) == 0)
+            {
+                std::filesystem::remove_all(entry.path());
+            }
+        }
+    }
+};
+
+// 多线程并发读写：读者之间不再串行，且始终读到完整的值
+TEST_F(FileStoreTest, ConcurrentReadersAndWriters)
+{
+    FileStore store(TEST_STORE_FILE, true);
+
+    const int N = 200;
+    for (int i = 0; i < N; ++i)
+    {
+        ASSERT_TRUE(store.put(i, "value_" + std::to_string(i)));
+    }
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&store, &mismatches, t]()
+                             {
+            for (int round = 0; round < 5; ++round) {
+                for (int i = 0; i < N; ++i) {
+                    if (store.get(i) != "value_" + std::to_string(i)) {
+                        mismatches++;
+                    }
+                }
+                store.put(N + t * 10 + round, "extra");
+            } });
+    }
+    threads.emplace_back([&store]()
+                         { store.garbageCollect(); });
+
+    for (auto &th : threads)
+    {
+        th.join();
+    }
+
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(store.get(N), "extra");
+}
+
+// 组提交：并发写入全部落盘且可读，批次数不超过写入次数
+TEST_F(FileStoreTest, GroupCommitConcurrentPuts)
+{
+    FileStore store(TEST_STORE_FILE, true);
+
+    const int THREADS = 8;
+    const int PER_THREAD = 100;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&store, t]()
+                             {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                int key = t * PER_THREAD + i;
+                EXPECT_TRUE(store.put(key, "v" + std::to_string(key)));
+            } });
+    }
+    for (auto &th : threads)
+    {
+        th.join();
+    }
+
+    for (int key = 0; key < THREADS * PER_THREAD; ++key)
+    {
+        EXPECT_EQ(store.get(key), "v" + std::to_string(key));
+    }
+    EXPECT_GE(store.getCommitBatchCount(), 1u);
+    EXPECT_LE(store.getCommitBatchCount(), static_cast<size_t>(THREADS * PER_THREAD));
+}
+
+// 崩溃恢复：旧检查点 + 日志尾部重放，末尾被撕裂的记录被截断
+TEST_F(FileStoreTest, RecoverFromCheckpointAndLogTail)
+{
+    const std::string crash_file = TEST_STORE_FILE + ".crash";
+    {
+        FileStore store(TEST_STORE_FILE, true);
+        for (int i = 0; i < 50; ++i)
+        {
+            store.put(i, "before_" + std::to_string(i));
+        }
+    } // 正常关闭，保存检查点
+
+    {
+        FileStore store(TEST_STORE_FILE);
+        for (int i = 50; i < 100; ++i)
+        {
+            store.put(i, "after_" + std::to_string(i));
+        }
+        store.put(0, "overwritten");
+        store.del(1);
+
+        // 进程仍在运行时复制文件，模拟 kill -9：检查点只覆盖前 50 条
+        std::filesystem::copy_file(TEST_STORE_FILE + ".00000001", crash_file + ".00000001");
+        std::filesystem::copy_file(TEST_STORE_FILE + ".idx", crash_file + ".idx");
+    }
+
+    // 模拟写了一半的记录
+    {
+        std::ofstream out(crash_file + ".00000001", std::ios::binary | std::ios::app);
+        out << "torn-record-bytes";
+    }
+
+    FileStore recovered(crash_file);
+    EXPECT_EQ(recovered.get(0), "overwritten");
+    EXPECT_TRUE(recovered.get(1).empty());
+    for (int i = 2; i < 50; ++i)
+    {
+        EXPECT_EQ(recovered.get(i), "before_" + std::to_string(i));
+    }
+    for (int i = 50; i < 100; ++i)
+    {
+        EXPECT_EQ(recovered.get(i), "after_" + std::to_string(i));
+    }
+
+    // 截断后的日志可以继续追加
+    EXPECT_TRUE(recovered.put(200, "appended"));
+    EXPECT_EQ(recovered.get(200), "appended");
+}
+
+// 追加量达到检查点间隔时由后台线程保存检查点，写入者不等待；间隔为 0 时只在关闭时保存
+TEST_F(FileStoreTest, BackgroundCheckpoint)
+{
+    const std::string index_file = TEST_STORE_FILE + ".idx";
+    FileStoreOptions options;
+    options.checkpoint_interval_bytes = 0;
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        for (int i = 0; i < 200; ++i)
+        {
+            store.put(i, std::string(100, 'x'));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(std::filesystem::exists(index_file));
+    }
+    EXPECT_TRUE(std::filesystem::exists(index_file));
+
+    options.checkpoint_interval_bytes = 4096;
+    FileStore store(TEST_STORE_FILE, true, options);
+    for (int i = 0; i < 200; ++i)
+    {
+        store.put(i, std::string(100, 'y'));
+    }
+    for (int i = 0; i < 500 && !std::filesystem::exists(index_file); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(std::filesystem::exists(index_file));
+}
+
+// 段滚动与定向压缩：覆盖写入计入垃圾，GC 只重写垃圾最多的段
+TEST_F(FileStoreTest, SegmentGarbageAccountingAndCompaction)
+{
+    FileStoreOptions options;
+    options.segment_size = 4096;
+    FileStore store(TEST_STORE_FILE, true, options);
+
+    const std::string value(100, 'x');
+    for (int i = 0; i < 100; ++i)
+    {
+        store.put(i, value);
+    }
+    // 覆盖前 40 个 key：旧值所在的段出现垃圾
+    for (int i = 0; i < 40; ++i)
+    {
+        store.put(i, "new_" + std::to_string(i));
+    }
+
+    auto before = store.getSegmentStats();
+    ASSERT_GT(before.size(), 2u);
+    size_t dead_before = 0;
+    for (const auto &seg : before)
+    {
+        EXPECT_LE(seg.size, options.segment_size);
+        dead_before += seg.dead_bytes;
+    }
+    EXPECT_EQ(dead_before, 40 * recordSize(value.size()));
+
+    store.garbageCollect();
+
+    auto after = store.getSegmentStats();
+    size_t dead_after = 0;
+    for (const auto &seg : after)
+    {
+        dead_after += seg.dead_bytes;
+    }
+    EXPECT_LT(dead_after, dead_before);
+    // 没有垃圾的段保持原样
+    EXPECT_EQ(after.back().id, before.back().id);
+
+    for (int i = 0; i < 40; ++i)
+    {
+        EXPECT_EQ(store.get(i), "new_" + std::to_string(i));
+    }
+    for (int i = 40; i < 100; ++i)
+    {
+        EXPECT_EQ(store.get(i), value);
+    }
+}
+
+// 压缩后重新打开：id 最大的段是压缩输出段，重新打开后的写入在崩溃后仍能重放；未发布的压缩输出被删除
+TEST_F(FileStoreTest, RecoverWritesAfterCompactionAndReopen)
+{
+    FileStoreOptions options;
+    options.segment_size = 4096;
+    const std::string crash_file = TEST_STORE_FILE + ".crash";
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        for (int i = 0; i < 100; ++i)
+        {
+            store.put(i, std::string(100, 'x'));
+        }
+        // 覆盖一半的 key：旧段中仍有有效记录，压缩会产生输出段
+        for (int i = 0; i < 100; i += 2)
+        {
+            store.put(i, "new_" + std::to_string(i));
+        }
+        EXPECT_GT(store.garbageCollect(), 0u);
+
+        // 压缩输出段的 id 大于当前段
+        auto stats = store.getSegmentStats();
+        auto active = std::find_if(stats.begin(), stats.end(), [](const SegmentStats &seg)
+                                   { return !seg.sealed; });
+        ASSERT_NE(active, stats.end());
+        ASSERT_LT(active->id, stats.back().id);
+    } // 正常关闭，保存检查点
+
+    {
+        FileStore store(TEST_STORE_FILE, false, options);
+        EXPECT_TRUE(store.put(1000, "after_reopen"));
+        store.put(0, "overwritten_after_reopen");
+
+        // 进程仍在运行时复制文件，模拟 kill -9：检查点不包含重新打开后的写入
+        for (const auto &entry : std::filesystem::directory_iterator(std::filesystem::path(TEST_STORE_FILE).parent_path()))
+        {
+            std::string name = entry.path().string();
+            if (name.rfind(TEST_STORE_FILE + ".", 0) == 0 && name.rfind(crash_file, 0) != 0)
+            {
+                std::filesystem::copy_file(name, crash_file + name.substr(TEST_STORE_FILE.size()));
+            }
+        }
+    }
+
+    // 崩溃时尚未发布的压缩输出段在打开时被删除
+    const std::string unpublished = crash_file + ".00009999.tmp";
+    std::ofstream(unpublished) << "partial-compaction-output";
+    FileStore recovered(crash_file, false, options);
+    EXPECT_FALSE(std::filesystem::exists(unpublished));
+    EXPECT_EQ(recovered.get(1000), "after_reopen");
+    EXPECT_EQ(recovered.get(0), "overwritten_after_reopen");
+    for (int i = 1; i < 100; ++i)
+    {
+        EXPECT_EQ(recovered.get(i), i % 2 == 0 ? "new_" + std::to_string(i) : std::string(100, 'x'));
+    }
+}
+
+// 在线压缩：GC 拷贝期间读写持续进行，拷贝期间被覆盖的 key 保留最新值
+TEST_F(FileStoreTest, OnlineCompactionKeepsConcurrentUpdates)
+{
+    FileStoreOptions options;
+    options.segment_size = 2048;
+    options.compact_garbage_ratio = 0.1;
+    FileStore store(TEST_STORE_FILE, true, options);
+
+    const int N = 200;
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < N; ++i)
+        {
+            store.put(i, "r" + std::to_string(round) + "_" + std::to_string(i));
+        }
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> bad_reads{0};
+    std::thread writer([&]()
+                       {
+        for (int i = 0; i < N; ++i) {
+            store.put(i, "final_" + std::to_string(i));
+        }
+        done = true; });
+    std::thread reader([&]()
+                       {
+        while (!done) {
+            for (int i = 0; i < N; i += 7) {
+                if (store.get(i).empty()) {
+                    bad_reads++;
+                }
+            }
+        } });
+
+    for (int i = 0; i < 5; ++i)
+    {
+        store.garbageCollect();
+    }
+    writer.join();
+    reader.join();
+    store.garbageCollect();
+
+    EXPECT_EQ(bad_reads.load(), 0);
+    for (int i = 0; i < N; ++i)
+    {
+        EXPECT_EQ(store.get(i), "final_" + std::to_string(i));
+    }
+
+    // 合并后的段统计与索引一致：有效字节恰好等于所有 key 最新记录的大小
+    size_t live = 0;
+    for (const auto &seg : store.getSegmentStats())
+    {
+        live += seg.live_bytes;
+    }
+    size_t expected = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        expected += recordSize(("final_" + std::to_string(i)).size());
+    }
+    EXPECT_EQ(live, expected);
+}
+
+// GC 调度：覆盖写入密集时后台线程按垃圾比例触发压缩，磁盘占用保持有界；无垃圾时不压缩
+TEST_F(FileStoreTest, GCSchedulerBoundsDiskUsage)
+{
+    FileStoreOptions options;
+    options.segment_size = 4096;
+    options.gc_check_interval = std::chrono::milliseconds(5);
+    options.gc_min_dead_bytes = 0;
+    FileStore store(TEST_STORE_FILE, true, options);
+
+    const std::string value(64, 'v');
+    for (int i = 0; i < 50; ++i)
+    {
+        store.put(i, value);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(store.getGCStats().runs, 0u); // 只有新数据，没有可回收的空间
+
+    for (int round = 0; round < 40; ++round)
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            store.put(i, value);
+        }
+    }
+
+    // 等待后台 GC 把空间放大压回阈值附近
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    size_t total = 0;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        total = 0;
+        for (const auto &seg : store.getSegmentStats())
+        {
+            total += seg.size;
+        }
+        if (total <= 4 * 50 * recordSize(value.size()))
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    GCStats stats = store.getGCStats();
+    EXPECT_GT(stats.runs, 0u);
+    EXPECT_GT(stats.total_reclaimed_bytes, 0u);
+    EXPECT_LE(total, 4 * 50 * recordSize(value.size()));
+    for (int i = 0; i < 50; ++i)
+    {
+        EXPECT_EQ(store.get(i), value);
+    }
+}
+
+// mmap 读模式：跨段读取、压缩后读取以及重启后读取均正确
+TEST_F(FileStoreTest, MmapReadPath)
+{
+    FileStoreOptions options;
+    options.segment_size = 4096;
+    options.use_mmap = true;
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        for (int i = 0; i < 200; ++i)
+        {
+            store.put(i, "mmap_" + std::to_string(i));
+        }
+        for (int i = 0; i < 100; ++i)
+        {
+            store.put(i, "again_" + std::to_string(i));
+        }
+        store.garbageCollect();
+
+        size_t reads_before = store.getReadCount();
+        for (int i = 0; i < 200; ++i)
+        {
+            EXPECT_EQ(store.get(i), (i < 100 ? "again_" : "mmap_") + std::to_string(i));
+        }
+        EXPECT_EQ(store.getReadCount(), reads_before + 200);
+    }
+
+    FileStore reopened(TEST_STORE_FILE, false, options);
+    for (int i = 0; i < 200; ++i)
+    {
+        EXPECT_EQ(reopened.get(i), (i < 100 ? "again_" : "mmap_") + std::to_string(i));
+    }
+}
+
+// 异步接口：io_uring 路径与同步回退路径的结果一致，且析构前回调全部执行完毕
+TEST_F(FileStoreTest, AsyncOperations)
+{
+    for (bool use_io_uring : {true, false})
+    {
+        cleanup();
+        FileStoreOptions options;
+        options.segment_size = 4096;
+        options.use_io_uring = use_io_uring;
+
+        const int N = 500;
+        std::atomic<int> put_ok{0};
+        std::atomic<int> get_ok{0};
+        std::atomic<int> del_ok{0};
+        {
+            FileStore store(TEST_STORE_FILE, true, options);
+            if (!use_io_uring)
+            {
+                EXPECT_FALSE(store.hasAsyncIo());
+            }
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; ++t)
+            {
+                threads.emplace_back([&store, &put_ok, t]()
+                                     {
+                    for (int i = t; i < N; i += 4) {
+                        store.asyncPut(i, "async_" + std::to_string(i), [&put_ok](bool res)
+                                       {
+                            if (res) {
+                                put_ok++;
+                            } });
+                    } });
+            }
+            for (auto &th : threads)
+            {
+                th.join();
+            }
+            while (put_ok.load() < N)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            for (int i = 0; i < N; ++i)
+            {
+                store.asyncGet(i, [&get_ok, i](std::string value)
+                               {
+                    if (value == "async_" + std::to_string(i)) {
+                        get_ok++;
+                    } });
+            }
+            for (int i = 0; i < N; i += 2)
+            {
+                store.asyncDel(i, [&del_ok](bool res)
+                               {
+                    if (res) {
+                        del_ok++;
+                    } });
+            }
+        }
+        EXPECT_EQ(get_ok.load(), N);
+        EXPECT_EQ(del_ok.load(), N / 2);
+
+        FileStore reopened(TEST_STORE_FILE, false, options);
+        for (int i = 0; i < N; ++i)
+        {
+            EXPECT_EQ(reopened.get(i), i % 2 == 0 ? "" : "async_" + std::to_string(i));
+        }
+    }
+}
+
+// 检查点为紧凑的定长格式；校验失败时丢弃检查点，从段文件重建索引
+TEST_F(FileStoreTest, PackedCheckpointAndCorruptionFallback)
+{
+    const int N = 1000;
+    {
+        FileStore store(TEST_STORE_FILE, true);
+        for (int i = 0; i < N; ++i)
+        {
+            store.put(i, "value_" + std::to_string(i));
+        }
+        for (int i = 0; i < N; i += 3)
+        {
+            store.del(i);
+        }
+    }
+
+    std::string index_path = TEST_STORE_FILE + ".idx";
+    EXPECT_EQ(std::filesystem::file_size(index_path), INDEX_FILE_HEADER_SIZE + N * INDEX_ENTRY_SIZE + INDEX_FILE_TRAILER_SIZE);
+
+    {
+        FileStore reopened(TEST_STORE_FILE);
+        for (int i = 0; i < N; ++i)
+        {
+            EXPECT_EQ(reopened.get(i), i % 3 == 0 ? "" : "value_" + std::to_string(i));
+        }
+    }
+
+    // 破坏一个索引项，加载时应检测到并完整重放日志
+    {
+        std::fstream index_file(index_path, std::ios::in | std::ios::out | std::ios::binary);
+        index_file.seekp(INDEX_FILE_HEADER_SIZE + 5 * INDEX_ENTRY_SIZE + 4);
+        index_file.put('\x7f');
+    }
+    FileStore rebuilt(TEST_STORE_FILE);
+    for (int i = 0; i < N; ++i)
+    {
+        EXPECT_EQ(rebuilt.get(i), i % 3 == 0 ? "" : "value_" + std::to_string(i));
+    }
+}
+
+// 封存段与压缩输出段都有提示文件；没有检查点时从提示文件重建索引，不扫描封存段中的 value
+TEST_F(FileStoreTest, RebuildIndexFromHintFiles)
+{
+    FileStoreOptions options;
+    options.segment_size = 4096;
+    std::string value(100, 'h');
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        for (int i = 0; i < 200; ++i)
+        {
+            store.put(i, value + std::to_string(i));
+        }
+        for (int i = 0; i < 100; ++i)
+        {
+            store.put(i, "new_" + std::to_string(i));
+        }
+        for (int i = 150; i < 200; ++i)
+        {
+            store.del(i);
+        }
+        EXPECT_GT(store.garbageCollect(), 0u);
+
+        std::vector<SegmentStats> stats = store.getSegmentStats();
+        for (const auto &seg : stats)
+        {
+            char name[16];
+            std::snprintf(name, sizeof(name), ".%08u", seg.id);
+            EXPECT_EQ(std::filesystem::exists(TEST_STORE_FILE + name + ".hint"), seg.sealed);
+        }
+    }
+
+    // 去掉检查点，并破坏第一个封存段中一条记录的 value：
+    // 若恢复时扫描该段会因校验失败而截断，使用提示文件则不会读到它
+    std::filesystem::remove(TEST_STORE_FILE + ".idx");
+    std::string first_segment;
+    for (const auto &entry : std::filesystem::directory_iterator("data"))
+    {
+        std::string name = entry.path().string();
+        if (name.rfind(TEST_STORE_FILE + ".", 0) == 0 && name.size() == TEST_STORE_FILE.size() + 9 &&
+            (first_segment.empty() || name < first_segment))
+        {
+            first_segment = name;
+        }
+    }
+    ASSERT_TRUE(std::filesystem::exists(first_segment + ".hint"));
+    size_t first_size = std::filesystem::file_size(first_segment);
+    {
+        std::fstream segment_file(first_segment, std::ios::in | std::ios::out | std::ios::binary);
+        segment_file.seekp(first_size - 1);
+        segment_file.put('\x7f');
+    }
+
+    FileStore reopened(TEST_STORE_FILE, false, options);
+    EXPECT_EQ(std::filesystem::file_size(first_segment), first_size);
+
+    // 除被破坏的那一条外，所有 key 都应恢复到最新状态
+    int mismatches = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string expected = i < 100 ? "new_" + std::to_string(i) : (i < 150 ? value + std::to_string(i) : "");
+        if (reopened.get(i) != expected)
+        {
+            mismatches++;
+        }
+    }
+    EXPECT_LE(mismatches, 1);
+}
+
+// 持久化策略：None 从不同步；PerWrite 每批同步一次；Interval 由后台线程同步
+TEST_F(FileStoreTest, SyncModes)
+{
+    const int N = 200;
+    auto write_all = [](FileStore &store)
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&store, t]()
+                                 {
+                for (int i = t; i < N; i += 4) {
+                    EXPECT_TRUE(store.put(i, "sync_" + std::to_string(i)));
+                } });
+        }
+        for (auto &th : threads)
+        {
+            th.join();
+        }
+    };
+
+    FileStoreOptions options;
+    options.sync_mode = SyncMode::None;
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        write_all(store);
+        EXPECT_EQ(store.getSyncCount(), 0u);
+    }
+
+    options.sync_mode = SyncMode::PerWrite;
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        write_all(store);
+        EXPECT_GT(store.getSyncCount(), 0u);
+        EXPECT_EQ(store.getSyncCount(), store.getCommitBatchCount());
+
+        // 异步写入同样在落盘后才回调
+        std::atomic<int> done{0};
+        for (int i = 0; i < N; ++i)
+        {
+            store.asyncPut(i, "async_sync_" + std::to_string(i), [&done](bool res)
+                           {
+                EXPECT_TRUE(res);
+                done++; });
+        }
+        while (done.load() < N)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(store.getSyncCount(), store.getCommitBatchCount());
+    }
+
+    options.sync_mode = SyncMode::Interval;
+    options.sync_interval = std::chrono::milliseconds(10);
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        write_all(store);
+        for (int i = 0; i < 200 && store.getSyncCount() == 0; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        EXPECT_GT(store.getSyncCount(), 0u);
+    }
+
+    FileStore reopened(TEST_STORE_FILE, false, options);
+    for (int i = 0; i < N; ++i)
+    {
+        EXPECT_EQ(reopened.get(i), "sync_" + std::to_string(i));
+    }
+}
+
+TEST_F(FileStoreTest, RangeScan)
+{
+    const int N = 3000;
+    FileStoreOptions options;
+    options.segment_size = 64 * 1024;
+    options.ordered_index = true;
+
+    // 期望结果：偶数 key 被删除，3 的倍数被覆盖
+    auto expected = [](int key)
+    {
+        if (key % 2 == 0)
+        {
+            return std::string();
+        }
+        return (key % 3 == 0 ? "new_" : "old_") + std::to_string(key);
+    };
+    auto check = [&](FileStore &store, int start, int end, size_t limit)
+    {
+        std::vector<ScanEntry> entries = store.scan(start, end, limit);
+        std::vector<int> keys;
+        for (int key = std::max(start, 0); key < std::min(end, N) && keys.size() < limit; ++key)
+        {
+            if (!expected(key).empty())
+            {
+                keys.push_back(key);
+            }
+        }
+        ASSERT_EQ(entries.size(), keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            EXPECT_EQ(entries[i].key, keys[i]);
+            EXPECT_EQ(entries[i].value, expected(keys[i]));
+        }
+    };
+
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        // 乱序写入，有序索引不依赖写入顺序
+        for (int i = 0; i < N; ++i)
+        {
+            int key = (i * 7919) % N;
+            store.put(key, "old_" + std::to_string(key));
+        }
+        for (int key = 0; key < N; key += 3)
+        {
+            store.put(key, "new_" + std::to_string(key));
+        }
+        for (int key = 0; key < N; key += 2)
+        {
+            store.del(key);
+        }
+
+        check(store, 100, 2100, 500);
+        check(store, -10, N + 10, SIZE_MAX);
+        check(store, 5, 5, 10);
+
+        // 区间内的记录在段中大多相邻，合并读取的次数远少于对象数
+        size_t reads_before = store.getReadCount();
+        EXPECT_EQ(store.scan(0, N).size(), static_cast<size_t>(N / 2));
+        EXPECT_LT(store.getReadCount() - reads_before, static_cast<size_t>(N / 20));
+
+        store.garbageCollect();
+        check(store, 0, N, SIZE_MAX);
+    }
+
+    // 重启后从索引重建有序索引；关闭有序索引时退化为遍历哈希索引，结果相同
+    {
+        FileStore reopened(TEST_STORE_FILE, false, options);
+        check(reopened, 1000, 1500, 100);
+        reopened.put(N + 1, "tail");
+        EXPECT_EQ(reopened.scan(N, N + 2).size(), 1u);
+    }
+    options.ordered_index = false;
+    FileStore unordered(TEST_STORE_FILE, false, options);
+    check(unordered, 1000, 1500, 100);
+}
+
+// 字节串 key：长短 key 混合、包含任意字节，检查点与提示文件都能正确恢复，扫描按字典序返回
+TEST_F(FileStoreTest, StringKeys)
+{
+    const int N = 2000;
+    FileStoreOptions options;
+    options.segment_size = 16 * 1024;
+    options.ordered_index = true;
+
+    // 奇数 key 超过内联长度，需单独分配内存
+    auto keyOf = [](int i)
+    {
+        std::string key = "user:" + std::to_string(i);
+        if (i % 2 == 1)
+        {
+            key += std::string(24, 'x');
+        }
+        return key;
+    };
+    // 期望结果：5 的倍数被删除，3 的倍数被覆盖
+    std::map<std::string, std::string> expected;
+    auto check = [&](StringFileStore &store)
+    {
+        for (int i = 0; i < N; ++i)
+        {
+            auto it = expected.find(keyOf(i));
+            EXPECT_EQ(store.get(keyOf(i)), it == expected.end() ? "" : it->second);
+        }
+        std::vector<BasicScanEntry<std::string>> entries = store.scan("user:1", "user:2");
+        auto first = expected.lower_bound("user:1");
+        auto last = expected.lower_bound("user:2");
+        ASSERT_EQ(entries.size(), static_cast<size_t>(std::distance(first, last)));
+        for (const auto &entry : entries)
+        {
+            EXPECT_EQ(entry.key, first->first);
+            EXPECT_EQ(entry.value, first->second);
+            ++first;
+        }
+    };
+
+    std::string binary_key("\0\xff\x01key", 6);
+    {
+        StringFileStore store(TEST_STORE_FILE, true, options);
+        for (int i = 0; i < N; ++i)
+        {
+            ASSERT_TRUE(store.put(keyOf(i), "old_" + std::to_string(i)));
+            expected[keyOf(i)] = "old_" + std::to_string(i);
+        }
+        for (int i = 0; i < N; i += 3)
+        {
+            store.put(keyOf(i), "new_" + std::to_string(i));
+            expected[keyOf(i)] = "new_" + std::to_string(i);
+        }
+        for (int i = 0; i < N; i += 5)
+        {
+            EXPECT_TRUE(store.del(keyOf(i)));
+            expected.erase(keyOf(i));
+        }
+        EXPECT_TRUE(store.put(binary_key, "binary"));
+        EXPECT_EQ(store.get(binary_key), "binary");
+        EXPECT_EQ(store.get(std::string("\0\xff\x01", 3)), "");
+
+        // 长度上限为 64 KiB - 1
+        EXPECT_TRUE(store.put(std::string(UINT16_MAX, 'k'), "max"));
+        EXPECT_FALSE(store.put(std::string(UINT16_MAX + 1, 'k'), "too_long"));
+        EXPECT_EQ(store.get(std::string(UINT16_MAX, 'k')), "max");
+        EXPECT_TRUE(store.del(std::string(UINT16_MAX, 'k')));
+
+        check(store);
+        EXPECT_GT(store.garbageCollect(), 0u);
+        check(store);
+    }
+
+    // 从前缀压缩的检查点恢复
+    {
+        StringFileStore reopened(TEST_STORE_FILE, false, options);
+        check(reopened);
+        EXPECT_EQ(reopened.get(binary_key), "binary");
+    }
+
+    // 去掉检查点，从提示文件与段扫描重建
+    std::filesystem::remove(TEST_STORE_FILE + ".idx");
+    StringFileStore rebuilt(TEST_STORE_FILE, false, options);
+    check(rebuilt);
+    EXPECT_EQ(rebuilt.get(binary_key), "binary");
+    EXPECT_EQ(rebuilt.get(std::string(UINT16_MAX, 'k')), "");
+}
+
+// 批量接口：一批写入只产生一个提交批次，批量读取把相邻记录合并成少量读取
+TEST_F(FileStoreTest, MultiGetAndMultiPut)
+{
+    for (bool use_io_uring : {true, false})
+    {
+        cleanup();
+        FileStoreOptions options;
+        options.use_io_uring = use_io_uring;
+        const int N = 1000;
+        FileStore store(TEST_STORE_FILE, true, options);
+
+        std::vector<std::pair<int, std::string>> items;
+        for (int i = 0; i < N; ++i)
+        {
+            items.emplace_back(i, "batch_" + std::to_string(i));
+        }
+        size_t batches_before = store.getCommitBatchCount();
+        ASSERT_TRUE(store.multiPut(items));
+        EXPECT_EQ(store.getCommitBatchCount() - batches_before, 1u);
+        EXPECT_TRUE(store.del(7));
+
+        // 乱序、重复、不存在与已删除的 key
+        std::vector<int> keys;
+        for (int i = 0; i < N; ++i)
+        {
+            keys.push_back((i * 7919) % N);
+        }
+        keys.push_back(N + 5);
+        keys.push_back(42);
+        auto expected = [](int key)
+        {
+            return key == 7 || key >= N ? std::string() : "batch_" + std::to_string(key);
+        };
+        size_t reads_before = store.getReadCount();
+        std::vector<std::string> values = store.multiGet(keys);
+        EXPECT_LE(store.getReadCount() - reads_before, 2u);
+        ASSERT_EQ(values.size(), keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            EXPECT_EQ(values[i], expected(keys[i]));
+        }
+        EXPECT_TRUE(store.multiGet(std::vector<int>()).empty());
+
+        // 异步版本各回调一次
+        std::vector<std::pair<int, std::string>> more;
+        for (int i = N; i < 2 * N; ++i)
+        {
+            more.emplace_back(i, "async_" + std::to_string(i));
+        }
+        std::atomic<int> put_calls{0};
+        std::atomic<bool> put_ok{false};
+        store.asyncMultiPut(more, [&](bool ok)
+                            {
+            put_ok = ok;
+            put_calls++; });
+        while (put_calls.load() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_TRUE(put_ok.load());
+
+        std::atomic<int> get_calls{0};
+        std::vector<std::string> async_values;
+        std::vector<int> async_keys = {N + 1, 3, 2 * N, 2 * N - 1};
+        store.asyncMultiGet(async_keys, [&](std::vector<std::string> result)
+                            {
+            async_values = std::move(result);
+            get_calls++; });
+        while (get_calls.load() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::vector<std::string> expected_async = {"async_" + std::to_string(N + 1), "batch_3", "", "async_" + std::to_string(2 * N - 1)};
+        EXPECT_EQ(async_values, expected_async);
+        EXPECT_EQ(put_calls.load(), 1);
+        EXPECT_EQ(get_calls.load(), 1);
+    }
+
+    // 有 key 超过长度上限时整批不写入
+    cleanup();
+    StringFileStore strings(TEST_STORE_FILE, true);
+    std::vector<std::pair<std::string, std::string>> bad = {{"a", "1"}, {std::string(UINT16_MAX + 1, 'k'), "2"}};
+    EXPECT_FALSE(strings.multiPut(bad));
+    EXPECT_EQ(strings.get("a"), "");
+}
+
+// 原子批次：一次写入一个批次帧；并发读者看不到只应用了一部分的批次；帧不完整时崩溃恢复整批丢弃
+TEST_F(FileStoreTest, WriteBatchAtomicity)
+{
+    const int K = 64;
+    {
+        FileStore store(TEST_STORE_FILE, true);
+        for (int i = 0; i < K; ++i)
+        {
+            store.put(i, "old");
+        }
+
+        WriteBatch batch;
+        batch.put(0, "first");
+        batch.put(0, "second"); // 同一 key 以最后一次为准
+        batch.del(1);
+        batch.del(K + 1); // 删除不存在的 key 不影响批次
+        batch.put(K, "added");
+        size_t batches_before = store.getCommitBatchCount();
+        EXPECT_TRUE(store.write(batch));
+        EXPECT_EQ(store.getCommitBatchCount() - batches_before, 1u);
+        EXPECT_EQ(store.get(0), "second");
+        EXPECT_EQ(store.get(1), "");
+        EXPECT_EQ(store.get(K), "added");
+        EXPECT_TRUE(store.write(WriteBatch()));
+
+        std::atomic<bool> async_done{false};
+        WriteBatch async_batch;
+        async_batch.put(K + 2, "async");
+        store.asyncWrite(async_batch, [&async_done](bool ok)
+                         {
+            EXPECT_TRUE(ok);
+            async_done = true; });
+        while (!async_done.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(store.get(K + 2), "async");
+
+        // 写者每轮把所有 key 改成同一个值，读者一次批量读取到的值必须全部相同
+        std::vector<int> keys;
+        WriteBatch initial;
+        for (int i = 0; i < K; ++i)
+        {
+            keys.push_back(i);
+            initial.put(i, "initial");
+        }
+        ASSERT_TRUE(store.write(initial));
+        std::atomic<bool> stop{false};
+        std::atomic<int> torn{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 3; ++t)
+        {
+            readers.emplace_back([&]()
+                                 {
+                while (!stop) {
+                    std::vector<std::string> values = store.multiGet(keys);
+                    if (std::adjacent_find(values.begin(), values.end(), std::not_equal_to<>()) != values.end()) {
+                        torn++;
+                    }
+                } });
+        }
+        for (int round = 0; round < 300; ++round)
+        {
+            WriteBatch all;
+            for (int key : keys)
+            {
+                all.put(key, "round_" + std::to_string(round));
+            }
+            ASSERT_TRUE(store.write(all));
+        }
+        stop = true;
+        for (auto &reader : readers)
+        {
+            reader.join();
+        }
+        EXPECT_EQ(torn.load(), 0);
+    } // 正常关闭，保存检查点
+
+    const std::string crash_file = TEST_STORE_FILE + ".crash";
+    {
+        FileStore store(TEST_STORE_FILE);
+        WriteBatch batch;
+        for (int i = 0; i < K; ++i)
+        {
+            batch.put(i, "crash_" + std::to_string(i));
+        }
+        batch.del(K);
+        ASSERT_TRUE(store.write(batch));
+        std::filesystem::copy_file(TEST_STORE_FILE + ".00000001", crash_file + ".00000001");
+        std::filesystem::copy_file(TEST_STORE_FILE + ".idx", crash_file + ".idx");
+    }
+
+    // 完整的帧：整批恢复
+    {
+        FileStore recovered(crash_file);
+        for (int i = 0; i < K; ++i)
+        {
+            EXPECT_EQ(recovered.get(i), "crash_" + std::to_string(i));
+        }
+        EXPECT_EQ(recovered.get(K), "");
+    }
+
+    // 帧的末尾没有写完：整批丢弃，前面的内部记录也不会被恢复。
+    // 上面关闭时保存的检查点已包含该批次，去掉它从日志重建
+    std::filesystem::remove(crash_file + ".idx");
+    std::filesystem::resize_file(crash_file + ".00000001", std::filesystem::file_size(crash_file + ".00000001") - 10);
+    FileStore truncated(crash_file);
+    for (int i = 0; i < K; ++i)
+    {
+        EXPECT_EQ(truncated.get(i), "round_299");
+    }
+    EXPECT_EQ(truncated.get(K), "added");
+}
+
+// 内联小 value：小 value 由索引直接返回，覆盖、删除、压缩与重启后仍然正确，占用不超过预算
+TEST_F(FileStoreTest, InlineSmallValues)
+{
+    const int N = 500;
+    const std::string large(1000, 'L');
+    FileStoreOptions options;
+    options.segment_size = 16 * 1024;
+    options.inline_value_max_size = 64;
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        for (int i = 0; i < N; ++i)
+        {
+            store.put(i, "small_" + std::to_string(i));
+        }
+        store.put(N, large);
+
+        size_t reads_before = store.getReadCount();
+        for (int i = 0; i < N; ++i)
+        {
+            ASSERT_EQ(store.get(i), "small_" + std::to_string(i));
+        }
+        std::vector<int> keys = {0, 1, 2, N - 1};
+        auto values = store.multiGet(keys);
+        EXPECT_EQ(values[3], "small_" + std::to_string(N - 1));
+        EXPECT_EQ(store.scan(10, 20).size(), 10u);
+        EXPECT_EQ(store.getReadCount(), reads_before);
+        EXPECT_EQ(store.get(N), large); // 超过阈值的 value 仍从磁盘读取
+        EXPECT_EQ(store.getReadCount(), reads_before + 1);
+        EXPECT_GE(store.getInlineValueStats().hits, static_cast<size_t>(N));
+
+        // 覆盖为大 value 后不再内联，删除后不可见；压缩搬移记录时保留内联的 value
+        store.put(0, large);
+        store.del(1);
+        for (int i = 2; i < N; i += 2)
+        {
+            store.put(i, "updated_" + std::to_string(i));
+        }
+        store.garbageCollect();
+        EXPECT_EQ(store.get(0), large);
+        EXPECT_EQ(store.get(1), "");
+        reads_before = store.getReadCount();
+        for (int i = 2; i < N; ++i)
+        {
+            ASSERT_EQ(store.get(i), (i % 2 ? "small_" : "updated_") + std::to_string(i));
+        }
+        EXPECT_EQ(store.getReadCount(), reads_before);
+    }
+
+    // 重启后从日志读回内联的 value
+    {
+        FileStore store(TEST_STORE_FILE, false, options);
+        EXPECT_GT(store.getInlineValueStats().bytes, 0u);
+        size_t reads_before = store.getReadCount();
+        for (int i = 2; i < N; ++i)
+        {
+            ASSERT_EQ(store.get(i), (i % 2 ? "small_" : "updated_") + std::to_string(i));
+        }
+        EXPECT_EQ(store.getReadCount(), reads_before);
+    }
+
+    // 预算很小时占用不超过预算，阈值随之下降，超出的 value 回落到磁盘读取
+    cleanup();
+    options.inline_value_budget = 4096;
+    FileStore store(TEST_STORE_FILE, true, options);
+    for (int i = 0; i < N; ++i)
+    {
+        store.put(i, std::string(40, 'a' + i % 26));
+    }
+    InlineValueStats stats = store.getInlineValueStats();
+    EXPECT_GT(stats.bytes, 0u);
+    EXPECT_LE(stats.bytes, options.inline_value_budget);
+    EXPECT_LT(stats.threshold, 40u);
+    for (int i = 0; i < N; ++i)
+    {
+        ASSERT_EQ(store.get(i), std::string(40, 'a' + i % 26));
+    }
+}
+
+// 键值分离：大 value 写入 blob 文件，主日志压缩不再拷贝它们；blob 文件垃圾足够多时才被重写，
+// 重启时从检查点记录的位置重放当前 blob 文件
+TEST_F(FileStoreTest, KeyValueSeparation)
+{
+    const int N = 200;
+    const int LARGE = 20;
+    FileStoreOptions options;
+    options.segment_size = 16 * 1024;
+    options.blob_value_threshold = 1024;
+    options.blob_file_size = 64 * 1024;
+    auto large = [](int i, int round)
+    { return std::string(8000, static_cast<char>('a' + (i + round) % 26)); };
+    auto blobIds = [](FileStore &store)
+    {
+        std::vector<uint32_t> ids;
+        for (const auto &seg : store.getSegmentStats())
+        {
+            if (seg.blob)
+            {
+                ids.push_back(seg.id);
+            }
+        }
+        return ids;
+    };
+
+    const std::string crash_file = TEST_STORE_FILE + ".crash";
+    {
+        FileStore store(TEST_STORE_FILE, true, options);
+        for (int i = 0; i < LARGE; ++i)
+        {
+            store.put(N + i, large(i, 0));
+        }
+        for (int round = 0; round < 10; ++round)
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                store.put(i, "small_" + std::to_string(round) + "_" + std::to_string(i));
+            }
+        }
+        std::vector<uint32_t> blobs = blobIds(store);
+        ASSERT_GT(blobs.size(), 1u);
+        EXPECT_TRUE(std::filesystem::exists(TEST_STORE_FILE + ".00000002.blob"));
+        for (const auto &seg : store.getSegmentStats())
+        {
+            if (!seg.blob)
+            {
+                EXPECT_LE(seg.size, options.segment_size); // 主日志段中没有大 value
+            }
+        }
+
+        // 只有主日志有垃圾：压缩不触碰 blob 文件
+        EXPECT_GT(store.garbageCollect(), 0u);
+        EXPECT_EQ(blobIds(store), blobs);
+
+        // 覆盖大部分大 value 后 blob 文件的垃圾比例达到阈值，被重写
+        for (int i = 0; i < LARGE - 2; ++i)
+        {
+            store.put(N + i, large(i, 1));
+        }
+        store.del(N + LARGE - 1);
+        EXPECT_GT(store.garbageCollect(), 0u);
+        EXPECT_NE(blobIds(store), blobs);
+
+        for (int i = 0; i < N; ++i)
+        {
+            ASSERT_EQ(store.get(i), "small_9_" + std::to_string(i));
+        }
+        std::vector<int> keys = {0, N, N + LARGE - 2, N + LARGE - 1};
+        auto values = store.multiGet(keys);
+        EXPECT_EQ(values[0], "small_9_0");
+        EXPECT_EQ(values[1], large(0, 1));
+        EXPECT_EQ(values[2], large(LARGE - 2, 0));
+        EXPECT_EQ(values[3], "");
+
+        // 检查点之后追加到当前 blob 文件的记录：复制出未正常关闭时的文件
+        // 提交令牌按顺序传递，同步 put 返回时前面的异步写已经完成回调
+        std::atomic<bool> async_ok{false};
+        store.asyncPut(N, large(0, 2), [&async_ok](bool res)
+                       { async_ok = res; });
+        store.put(N + 1, large(1, 2));
+        store.sync();
+        EXPECT_TRUE(async_ok.load());
+        for (const auto &entry : std::filesystem::directory_iterator(std::filesystem::path(TEST_STORE_FILE).parent_path()))
+        {
+            std::string name = entry.path().string();
+            if (name.rfind(TEST_STORE_FILE + ".", 0) == 0 && name.rfind(crash_file, 0) != 0)
+            {
+                std::filesystem::copy_file(name, crash_file + name.substr(TEST_STORE_FILE.size()));
+            }
+        }
+    }
+
+    for (const std::string &path : {crash_file, TEST_STORE_FILE})
+    {
+        FileStore reopened(path, false, options);
+        EXPECT_EQ(reopened.get(N), large(0, 2));
+        EXPECT_EQ(reopened.get(N + 1), large(1, 2));
+        EXPECT_EQ(reopened.get(N + LARGE - 2), large(LARGE - 2, 0));
+        EXPECT_EQ(reopened.get(N + LARGE - 1), "");
+        EXPECT_EQ(reopened.get(7), "small_9_7");
+    }
+
+    // 没有检查点时从主日志与 blob 文件重建索引
+    std::filesystem::remove(crash_file + ".idx");
+    {
+        FileStore rebuilt(crash_file, false, options);
+        EXPECT_EQ(rebuilt.get(N + 1), large(1, 2));
+        EXPECT_EQ(rebuilt.get(N + 5), large(5, 1));
+        EXPECT_EQ(rebuilt.get(N + LARGE - 1), "");
+    }
+
+    // blob 压缩后重新打开：id 最大的 blob 文件是压缩输出，重新打开后写入的大 value 在崩溃后仍能重放
+    {
+        FileStore store(TEST_STORE_FILE, false, options);
+        for (int i = 0; i < LARGE; i += 2)
+        {
+            store.put(N + i, large(i, 3)); // 每个 blob 文件都留下部分有效记录
+        }
+        EXPECT_GT(store.garbageCollect(), 0u);
+        auto stats = store.getSegmentStats();
+        auto newest_blob = std::find_if(stats.rbegin(), stats.rend(), [](const SegmentStats &seg)
+                                        { return seg.blob; });
+        ASSERT_NE(newest_blob, stats.rend());
+        ASSERT_TRUE(newest_blob->sealed);
+    }
+    const std::string reopen_crash_file = crash_file + "_reopen";
+    {
+        FileStore store(TEST_STORE_FILE, false, options);
+        EXPECT_TRUE(store.put(N + 2, large(2, 4)));
+        for (const auto &entry : std::filesystem::directory_iterator(std::filesystem::path(TEST_STORE_FILE).parent_path()))
+        {
+            std::string name = entry.path().string();
+            if (name.rfind(TEST_STORE_FILE + ".", 0) == 0 && name.rfind(crash_file, 0) != 0)
+            {
+                std::filesystem::copy_file(name, reopen_crash_file + name.substr(TEST_STORE_FILE.size()));
+            }
+        }
+    }
+    FileStore recovered(reopen_crash_file, false, options);
+    EXPECT_EQ(recovered.get(N + 2), large(2, 4));
+    EXPECT_EQ(recovered.get(N + 4), large(4, 3));
+    EXPECT_EQ(recovered.get(N + 1), large(1, 2));
+}
+
+// 并行压缩：多个线程各自拷贝一部分段，有无提示文件（按提示项或扫描定位记录）结果相同
+TEST_F(FileStoreTest, ParallelCompaction)
+{
+    for (bool hint_files : {true, false})
+    {
+        cleanup();
+        FileStoreOptions options;
+        options.segment_size = 4096;
+        options.max_compact_segments = 64;
+        options.compaction_threads = 4;
+        options.hint_files = hint_files;
+
+        const int N = 1000;
+        {
+            FileStore store(TEST_STORE_FILE, true, options);
+            for (int i = 0; i < N; ++i)
+            {
+                store.put(i, "value_" + std::to_string(i));
+            }
+            // 每三个 key 覆盖或删除两个，留下的有效记录在段内不连续
+            for (int i = 0; i < N; ++i)
+            {
+                if (i % 3 == 1)
+                {
+                    store.put(i, "updated_" + std::to_string(i));
+                }
+                else if (i % 3 == 2)
+                {
+                    store.del(i);
+                }
+            }
+            EXPECT_GT(store.garbageCollect(), 0u);
+
+            for (int i = 0; i < N; ++i)
+            {
+                ASSERT_EQ(store.get(i), i % 3 == 0 ? "value_" + std::to_string(i) : i % 3 == 1 ? "updated_" + std::to_string(i) : "");
+            }
+        }
+
+        // 从段文件（及输出段的提示文件）重建后结果不变
+        std::filesystem::remove(TEST_STORE_FILE + ".idx");
+        FileStore reopened(TEST_STORE_FILE, false, options);
+        for (int i = 0; i < N; ++i)
+        {
+            ASSERT_EQ(reopened.get(i), i % 3 == 0 ? "value_" + std::to_string(i) : i % 3 == 1 ? "updated_" + std::to_string(i) : "");
+        }
+    }
+}
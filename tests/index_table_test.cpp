@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "index_table.h"
+#include <unordered_map>
+#include <random>
+
+// 随机插入、覆盖、删除，与 std::unordered_map 的结果逐项对比，覆盖扩容迁移过程中的读写
+TEST(IndexTableTest, MatchesReferenceMap)
+{
+    IndexTable table;
+    std::unordered_map<int, ObjectMeta> reference;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key_dist(-5000, 5000);
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        int key = key_dist(rng);
+        int op = rng() % 10;
+        if (op < 6)
+        {
+            bool deleted = op == 5;
+            ObjectMeta meta{key, static_cast<uint32_t>(rng() % 1000), static_cast<size_t>(rng()) * 7, deleted ? 0 : rng() % 4096, deleted};
+            table.insert(meta);
+            reference[key] = meta;
+        }
+        else if (op < 8)
+        {
+            EXPECT_EQ(table.erase(key), reference.erase(key) == 1);
+        }
+        else
+        {
+            ObjectMeta meta;
+            auto it = reference.find(key);
+            ASSERT_EQ(table.find(key, meta), it != reference.end());
+            if (it != reference.end())
+            {
+                EXPECT_EQ(meta.segment_id, it->second.segment_id);
+                EXPECT_EQ(meta.offset, it->second.offset);
+                EXPECT_EQ(meta.size, it->second.size);
+                EXPECT_EQ(meta.deleted, it->second.deleted);
+            }
+        }
+        ASSERT_EQ(table.size(), reference.size());
+    }
+
+    size_t visited = 0;
+    table.forEach([&](const ObjectMeta &meta)
+                  {
+        visited++;
+        auto it = reference.find(meta.key);
+        ASSERT_NE(it, reference.end());
+        EXPECT_EQ(meta.offset, it->second.offset); });
+    EXPECT_EQ(visited, reference.size());
+}
+
+// 顺序插入大量 key：位置字段取到上限仍能还原，且内存占用为每项十几个字节
+TEST(IndexTableTest, GrowsIncrementallyWithCompactSlots)
+{
+    const int num_keys = 1 << 20;
+    IndexTable table;
+    for (int key = 0; key < num_keys; ++key)
+    {
+        table.insert(ObjectMeta{key, IndexTable::MAX_SEGMENT_ID, IndexTable::MAX_OFFSET - key, static_cast<size_t>(key), false});
+    }
+    ASSERT_EQ(table.size(), static_cast<size_t>(num_keys));
+    for (int key = 0; key < num_keys; key += 997)
+    {
+        ObjectMeta meta;
+        ASSERT_TRUE(table.find(key, meta));
+        EXPECT_EQ(meta.segment_id, IndexTable::MAX_SEGMENT_ID);
+        EXPECT_EQ(meta.offset, IndexTable::MAX_OFFSET - key);
+        EXPECT_EQ(meta.size, static_cast<size_t>(key));
+    }
+    ObjectMeta missing;
+    EXPECT_FALSE(table.find(num_keys, missing));
+    EXPECT_LE(table.memoryUsage(), static_cast<size_t>(num_keys) * 17 * 2);
+
+    // 预留空间后一次分配到位，插入过程不再扩容
+    IndexTable reserved;
+    reserved.reserve(num_keys);
+    size_t usage = reserved.memoryUsage();
+    for (int key = 0; key < num_keys; ++key)
+    {
+        reserved.insert(ObjectMeta{key, 1, 0, 0, true});
+    }
+    EXPECT_EQ(reserved.memoryUsage(), usage);
+
+    table.clear();
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_EQ(table.memoryUsage(), 0u);
+}
+
+// 字节串 key：短 key 内联在槽内，长 key 单独分配，扩容与删除后仍与参照表一致
+TEST(IndexTableTest, StringKeys)
+{
+    BasicIndexTable<std::string> table;
+    std::unordered_map<std::string, size_t> reference;
+    std::mt19937 rng(7);
+    for (int i = 0; i < 100000; ++i)
+    {
+        std::string key = "k" + std::to_string(rng() % 50000);
+        if (rng() % 2)
+        {
+            key.append(rng() % 40, static_cast<char>(rng()));
+        }
+        if (rng() % 4 == 0)
+        {
+            table.erase(key);
+            reference.erase(key);
+        }
+        else
+        {
+            size_t size = rng() % 1000;
+            table.insert(BasicObjectMeta<std::string>{key, 1, static_cast<size_t>(i), size, false});
+            reference[key] = size;
+        }
+    }
+    ASSERT_EQ(table.size(), reference.size());
+    for (const auto &[key, size] : reference)
+    {
+        BasicObjectMeta<std::string> meta;
+        ASSERT_TRUE(table.find(key, meta));
+        EXPECT_EQ(meta.key, key);
+        EXPECT_EQ(meta.size, size);
+    }
+    size_t visited = 0;
+    table.forEach([&](const BasicObjectMeta<std::string> &meta)
+                  {
+        visited++;
+        EXPECT_EQ(reference.count(meta.key), 1u); });
+    EXPECT_EQ(visited, reference.size());
+    BasicObjectMeta<std::string> missing;
+    EXPECT_FALSE(table.find("absent", missing));
+}
+
+// 内联 value：覆盖、删除、扩容迁移与搬移位置后保持正确，占用随之增减
+TEST(IndexTableTest, InlineValues)
+{
+    const int num_keys = 10000;
+    IndexTable table;
+    table.enableInlineValues();
+    for (int key = 0; key < num_keys; ++key)
+    {
+        std::string value = "v" + std::to_string(key);
+        ObjectMeta meta{key, 1, static_cast<size_t>(key), value.size(), false};
+        meta.value = value.data();
+        table.insert(meta);
+    }
+    size_t odd_bytes = 0;
+    for (int key = 1; key < num_keys; key += 2)
+    {
+        odd_bytes += IndexTable::inlineCost(("v" + std::to_string(key)).size());
+    }
+    EXPECT_GT(table.inlineBytes(), odd_bytes);
+
+    for (int key = 0; key < num_keys; key += 2)
+    {
+        if (key % 4 == 0)
+        {
+            table.insert(ObjectMeta{key, 2, 0, 100, false}); // 不带 value 的覆盖去掉内联
+        }
+        else
+        {
+            table.erase(key);
+        }
+    }
+    for (int key = 1; key < num_keys; key += 2)
+    {
+        EXPECT_TRUE(table.relocate(ObjectMeta{key, 3, static_cast<size_t>(key) * 2, 0, false}));
+    }
+    EXPECT_FALSE(table.relocate(ObjectMeta{2, 3, 0, 0, false}));
+    EXPECT_EQ(table.inlineBytes(), odd_bytes);
+
+    for (int key = 0; key < num_keys; ++key)
+    {
+        ObjectMeta meta;
+        if (key % 2 == 1)
+        {
+            ASSERT_TRUE(table.find(key, meta));
+            EXPECT_EQ(meta.segment_id, 3u);
+            ASSERT_NE(meta.value, nullptr);
+            EXPECT_EQ(std::string(meta.value, meta.size), "v" + std::to_string(key));
+        }
+        else if (key % 4 == 0)
+        {
+            ASSERT_TRUE(table.find(key, meta));
+            EXPECT_EQ(meta.value, nullptr);
+        }
+        else
+        {
+            EXPECT_FALSE(table.find(key, meta));
+        }
+    }
+
+    table.clear();
+    EXPECT_EQ(table.inlineBytes(), 0u);
+}
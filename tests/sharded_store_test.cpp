@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "sharded_store.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <filesystem>
+
+static const std::string TEST_SHARDED_FILE = "data/test_sharded_store.dat";
+
+class ShardedStoreTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        cleanup();
+    }
+
+    void TearDown() override
+    {
+        cleanup();
+    }
+
+    // 删除所有分片的数据文件及附属文件
+    void cleanup()
+    {
+        std::filesystem::path dir = std::filesystem::path(TEST_SHARDED_FILE).parent_path();
+        std::string prefix = std::filesystem::path(TEST_SHARDED_FILE).filename().string();
+        if (!std::filesystem::exists(dir))
+        {
+            return;
+        }
+        for (const auto &entry : std::filesystem::directory_iterator(dir))
+        {
+            if (entry.path().filename().string().rfind(prefix, 0) == 0)
+            {
+                std::filesystem::remove_all(entry.path());
+            }
+        }
+    }
+};
+
+// key 均匀分布到各分片，每个分片只保存自己的 key，并发写入后重启数据完整
+TEST_F(ShardedStoreTest, RoutesKeysAcrossShards)
+{
+    const int N = 4000;
+    {
+        ShardedFileStore store(TEST_SHARDED_FILE, 4, true);
+        ASSERT_EQ(store.shardCount(), 4u);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&store, t]()
+                                 {
+                for (int i = t; i < N; i += 4) {
+                    EXPECT_TRUE(store.put(i, "shard_" + std::to_string(i)));
+                } });
+        }
+        for (auto &th : threads)
+        {
+            th.join();
+        }
+
+        std::vector<int> per_shard(4, 0);
+        for (int i = 0; i < N; ++i)
+        {
+            size_t shard = store.shardFor(i);
+            per_shard[shard]++;
+            EXPECT_EQ(store.shard(shard).get(i), "shard_" + std::to_string(i));
+            EXPECT_EQ(store.shard((shard + 1) % 4).get(i), "");
+        }
+        for (int count : per_shard)
+        {
+            EXPECT_GT(count, N / 8);
+        }
+        for (int i = 0; i < N; i += 2)
+        {
+            EXPECT_TRUE(store.del(i));
+        }
+    }
+
+    // 以不同的分片数重新打开时沿用创建时的分片数
+    ShardedFileStore reopened(TEST_SHARDED_FILE, 2);
+    EXPECT_EQ(reopened.shardCount(), 4u);
+    for (int i = 0; i < N; ++i)
+    {
+        EXPECT_EQ(reopened.get(i), i % 2 == 0 ? "" : "shard_" + std::to_string(i));
+    }
+}
+
+// 没有分片数文件的未分片存储以多个分片打开时仍按 1 个分片读取原有数据，分片数文件随之写入
+TEST_F(ShardedStoreTest, OpensExistingUnshardedStore)
+{
+    {
+        FileStore store(TEST_SHARDED_FILE, true);
+        for (int i = 0; i < 100; ++i)
+        {
+            ASSERT_TRUE(store.put(i, "legacy_" + std::to_string(i)));
+        }
+    }
+    ASSERT_FALSE(std::filesystem::exists(TEST_SHARDED_FILE + ".shards"));
+
+    {
+        ShardedFileStore store(TEST_SHARDED_FILE, 4);
+        EXPECT_EQ(store.shardCount(), 1u);
+        for (int i = 0; i < 100; ++i)
+        {
+            EXPECT_EQ(store.get(i), "legacy_" + std::to_string(i));
+        }
+    }
+    EXPECT_TRUE(std::filesystem::exists(TEST_SHARDED_FILE + ".shards"));
+    EXPECT_FALSE(std::filesystem::exists(TEST_SHARDED_FILE + ".shards.tmp"));
+
+    ShardedFileStore reopened(TEST_SHARDED_FILE, 8);
+    EXPECT_EQ(reopened.shardCount(), 1u);
+    EXPECT_EQ(reopened.get(99), "legacy_99");
+}
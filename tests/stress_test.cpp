@@ -8,6 +8,10 @@
 #include <unordered_map>
 #include <mutex>
 #include <condition_variable>
+#include <algorithm>
+#include <string>
+#include <list>
+#include <cmath>
 #include "engine.h" 
 
 // 配置参数
@@ -206,20 +210,217 @@ void stats_thread()
     }
 }
 
-int main()
+// 删除以 file 为前缀的所有数据文件
+void remove_db_files(const std::string &file)
 {
     using namespace std::filesystem;
+    path db_path(file);
+    if (exists(db_path.parent_path()))
+    {
+        for (const auto &entry : directory_iterator(db_path.parent_path()))
+        {
+            if (entry.path().filename().string().rfind(db_path.filename().string(), 0) == 0)
+            {
+                remove(entry.path());
+            }
+        }
+    }
+}
+
+// 持久化策略基准：各模式下并发写入固定数量的记录，报告吞吐量与延迟分位数
+void run_sync_benchmark()
+{
+    const std::string bench_file = "data/sync_bench_db.dat";
+    const int bench_threads = 8;
+    const int puts_per_thread = 2000;
+    const std::string value(100, 'v');
+
+    struct Mode
+    {
+        const char *name;
+        SyncMode mode;
+    };
+    const Mode modes[] = {{"none", SyncMode::None}, {"interval", SyncMode::Interval}, {"per-write", SyncMode::PerWrite}};
+
+    std::cout << "Sync mode benchmark: " << bench_threads << " threads x " << puts_per_thread << " puts\n";
+    for (const Mode &m : modes)
+    {
+        remove_db_files(bench_file);
+        FileStoreOptions options;
+        options.sync_mode = m.mode;
+        options.sync_interval = std::chrono::milliseconds(100);
+
+        std::vector<std::vector<double>> latencies(bench_threads);
+        std::chrono::duration<double> elapsed{};
+        {
+            StorageEngine engine(bench_file, 4, 1000, 8, 1, options);
+            auto begin = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            for (int t = 0; t < bench_threads; ++t)
+            {
+                threads.emplace_back([&engine, &latencies, &value, t, puts_per_thread]()
+                                     {
+                    latencies[t].reserve(puts_per_thread);
+                    for (int i = 0; i < puts_per_thread; ++i) {
+                        auto op_begin = std::chrono::steady_clock::now();
+                        engine.put(t * puts_per_thread + i, value);
+                        std::chrono::duration<double, std::micro> op = std::chrono::steady_clock::now() - op_begin;
+                        latencies[t].push_back(op.count());
+                    } });
+            }
+            for (auto &th : threads)
+            {
+                th.join();
+            }
+            elapsed = std::chrono::steady_clock::now() - begin;
+        }
+
+        std::vector<double> all;
+        for (const auto &l : latencies)
+        {
+            all.insert(all.end(), l.begin(), l.end());
+        }
+        std::sort(all.begin(), all.end());
+        auto percentile = [&all](double p)
+        {
+            return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))];
+        };
+        std::cout << "[" << m.name << "] "
+                  << "Throughput: " << all.size() / elapsed.count() << " ops/s | "
+                  << "Latency(us) p50: " << percentile(0.50) << " p99: " << percentile(0.99) << " max: " << all.back() << "\n";
+    }
+    remove_db_files(bench_file);
+}
+
+// 缓存命中率基准：zipf 分布的热点访问中周期性插入一次性的顺序扫描，按旁路缓存的方式（未命中后回填）
+// 对比参照的严格 LRU、普通 CLOCK 与开启 W-TinyLFU 准入的 CLOCK 的命中率
+void run_cache_benchmark()
+{
+    const size_t capacity = 10000;
+    const size_t num_segments = 8;
+    const size_t hot_keys = 200000;
+    const size_t accesses = 2000000;
+    const size_t scan_every = 100000; // 每隔多少次热点访问插入一次扫描
+    const size_t scan_length = 50000;
+    const std::string value(16, 'v');
+
+    // zipf(0.99) 的累积分布，按二分查找采样
+    std::vector<double> cdf(hot_keys);
+    double sum = 0;
+    for (size_t i = 0; i < hot_keys; ++i)
+    {
+        sum += 1.0 / std::pow(static_cast<double>(i + 1), 0.99);
+        cdf[i] = sum;
+    }
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> uniform(0, sum);
+    std::vector<int> hot_trace(accesses);
+    for (auto &key : hot_trace)
+    {
+        key = static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin());
+    }
 
-    // 清理原数据文件
-    if (exists(TEST_DB_FILE))
+    // 参照的严格 LRU（单段、单线程）
+    struct ReferenceLru
     {
-        remove(TEST_DB_FILE);
+        size_t capacity;
+        std::list<int> order;
+        std::unordered_map<int, std::list<int>::iterator> index;
+
+        bool get(int key, std::string &)
+        {
+            auto it = index.find(key);
+            if (it == index.end())
+            {
+                return false;
+            }
+            order.splice(order.begin(), order, it->second);
+            return true;
+        }
+        void put(int key, const std::string &)
+        {
+            order.push_front(key);
+            index[key] = order.begin();
+            if (order.size() > capacity)
+            {
+                index.erase(order.back());
+                order.pop_back();
+            }
+        }
+    };
+
+    // 返回热点访问的命中率与全部访问的命中率
+    auto replay = [&](auto &cache, bool with_scans)
+    {
+        size_t hot_hits = 0;
+        size_t hits = 0;
+        size_t total = 0;
+        int next_scan_key = static_cast<int>(hot_keys);
+        std::string out;
+        auto access = [&](int key)
+        {
+            total++;
+            if (cache.get(key, out))
+            {
+                hits++;
+                return true;
+            }
+            cache.put(key, value);
+            return false;
+        };
+        for (size_t i = 0; i < accesses; ++i)
+        {
+            if (with_scans && i % scan_every == scan_every / 2)
+            {
+                for (size_t j = 0; j < scan_length; ++j)
+                {
+                    access(next_scan_key++);
+                }
+            }
+            hot_hits += access(hot_trace[i]) ? 1 : 0;
+        }
+        return std::make_pair(100.0 * hot_hits / accesses, 100.0 * hits / total);
+    };
+
+    std::cout << "Cache hit ratio benchmark: capacity " << capacity << ", zipf(0.99) over " << hot_keys << " keys, "
+              << accesses << " accesses\n";
+    for (bool with_scans : {false, true})
+    {
+        const char *workload = with_scans ? "zipf+scan" : "zipf";
+        auto report = [workload](const char *policy, std::pair<double, double> ratio)
+        {
+            std::cout << "[" << workload << "] " << policy << " hot hit ratio: " << ratio.first << "% | overall: " << ratio.second << "%\n";
+        };
+
+        ReferenceLru lru{capacity, {}, {}};
+        report("lru      ", replay(lru, with_scans));
+
+        ClockCache clock(capacity, num_segments);
+        report("clock    ", replay(clock, with_scans));
+
+        CacheOptions options;
+        options.admission = true;
+        ClockCache tinylfu(capacity, num_segments, options);
+        report("w-tinylfu", replay(tinylfu, with_scans));
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && std::string(argv[1]) == "--sync-bench")
+    {
+        run_sync_benchmark();
+        return 0;
     }
-    if (exists(TEST_DB_FILE + ".idx"))
+    if (argc > 1 && std::string(argv[1]) == "--cache-bench")
     {
-        remove(TEST_DB_FILE + ".idx");
+        run_cache_benchmark();
+        return 0;
     }
 
+    // 清理原数据文件（数据段文件与索引文件均以 TEST_DB_FILE 为前缀）
+    remove_db_files(TEST_DB_FILE);
+
     // 初始化引擎
     // 参数根据你的实现进行调整（线程池大小、缓存容量、段数）
     StorageEngine engine(TEST_DB_FILE, 16, 200000, 32);